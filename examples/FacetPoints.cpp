@@ -53,12 +53,15 @@ int main() {
 
   auto fig = figure();
   auto ax = fig->axis();
-  auto data =
-      create_data().x(csv["gdpPercap"]).y(csv["lifeExp"]).size(csv["pop"]).color(csv["continent"]);
+  DataWithAesthetic data(csv.data);
+  data.bind<Aesthetic::x>(csv.column("gdpPercap"));
+  data.bind<Aesthetic::y>(csv.column("lifeExp"));
+  data.bind<Aesthetic::size>(csv.column("pop"));
+  data.bind<Aesthetic::color>(csv.column("continent"));
 
   data.x(0, 4e4).y(20, 84);
 
-  auto faceted_data = data.facet(csv["year"]);
+  auto faceted_data = data.facet(csv.data->decoded(csv.column("year")));
 
   auto facet = faceted_data.begin();
   auto points = ax->points(facet->second);
@@ -52,10 +52,10 @@ int main() {
       {"sepal_length", "sepal_width", "petal_length", "petal_width", "class"});
   auto fig = figure();
   auto ax = fig->axis();
-  auto data = create_data()
-                  .x(csv["sepal_length"])
-                  .y(csv["sepal_width"])
-                  .color(csv["petal_width"]);
+  DataWithAesthetic data(csv.data);
+  data.bind<Aesthetic::x>(csv.column("sepal_length"));
+  data.bind<Aesthetic::y>(csv.column("sepal_width"));
+  data.bind<Aesthetic::color>(csv.column("petal_width"));
 
   auto points = ax->points(data);
 
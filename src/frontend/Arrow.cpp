@@ -0,0 +1,315 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "frontend/Arrow.hpp"
+
+namespace trase {
+
+namespace {
+
+/// returns true if element i (of a column starting at @p offset) is not null
+bool is_valid(const ArrowArray &array, const int64_t offset, const int64_t i) {
+  const auto validity = static_cast<const uint8_t *>(array.buffers[0]);
+  if (array.null_count == 0 || validity == nullptr) {
+    return true;
+  }
+  const int64_t bit = offset + i;
+  return ((validity[bit / 8] >> (bit % 8)) & 1) != 0;
+}
+
+/// the validity of the elements of a column. An element of a child of a
+/// struct is null if either the child or the struct marks it as null
+struct Validity {
+  const ArrowArray &array;
+
+  /// the element of the array buffers that the column starts at
+  int64_t offset;
+
+  /// the struct the column is a child of, or nullptr
+  const ArrowArray *parent;
+
+  /// the element of the parent validity buffer that the column starts at
+  int64_t parent_offset;
+
+  /// returns true if the column might have null elements
+  bool has_nulls() const {
+    return (array.null_count != 0 && array.buffers[0] != nullptr) ||
+           (parent && parent->null_count != 0 &&
+            parent->buffers[0] != nullptr);
+  }
+
+  /// returns true if element i of the column is not null
+  bool operator()(const int64_t i) const {
+    return is_valid(array, offset, i) &&
+           (!parent || is_valid(*parent, parent_offset, i));
+  }
+};
+
+/// converts @p n values of type T to an offset encoded float column, nulls
+/// become NaN
+template <typename T>
+Column import_values(const Validity &valid, const int64_t n) {
+  const T *values =
+      static_cast<const T *>(valid.array.buffers[1]) + valid.offset;
+
+  // the offset is the min of the (non-null, non-NaN) values
+  bool have_min = false;
+  T min = T();
+  for (int64_t i = 0; i < n; ++i) {
+    if (values[i] == values[i] && valid(i) &&
+        (!have_min || values[i] < min)) {
+      min = values[i];
+      have_min = true;
+    }
+  }
+
+  std::vector<float> column(static_cast<size_t>(n));
+  for (int64_t i = 0; i < n; ++i) {
+    column[i] = valid(i) ? static_cast<float>(values[i] - min)
+                    : std::numeric_limits<float>::quiet_NaN();
+  }
+  return Column(std::move(column), static_cast<double>(min));
+}
+
+/// converts the @p n indices of a dictionary column to codes into the sorted
+/// dictionary, using @p codes to map each index to its code. nulls become NaN
+template <typename T>
+std::vector<float> import_indices(const Validity &valid, const int64_t n,
+                                  const std::vector<float> &codes) {
+  const T *indices =
+      static_cast<const T *>(valid.array.buffers[1]) + valid.offset;
+  std::vector<float> column(static_cast<size_t>(n));
+  for (int64_t i = 0; i < n; ++i) {
+    if (!valid(i)) {
+      column[i] = std::numeric_limits<float>::quiet_NaN();
+    } else if (static_cast<uint64_t>(indices[i]) >= codes.size()) {
+      // note: negative indices are also out of range after the cast
+      throw Exception("Arrow dictionary index out of range");
+    } else {
+      column[i] = codes[static_cast<size_t>(indices[i])];
+    }
+  }
+  return column;
+}
+
+/// reads the strings of a utf8 array, with offsets of type T
+template <typename T>
+std::vector<std::string> import_strings(const ArrowArray &array) {
+  const T *offsets = static_cast<const T *>(array.buffers[1]) + array.offset;
+  const char *data = static_cast<const char *>(array.buffers[2]);
+  std::vector<std::string> strings(static_cast<size_t>(array.length));
+  for (int64_t i = 0; i < array.length; ++i) {
+    strings[i].assign(data + offsets[i], data + offsets[i + 1]);
+  }
+  return strings;
+}
+
+/// returns the single character of a primitive Arrow format string, or 0 if
+/// the format is not a single character
+char primitive_format(const ArrowSchema &schema) {
+  return schema.format[0] != '\0' && schema.format[1] == '\0'
+             ? schema.format[0]
+             : '\0';
+}
+
+Exception unsupported_format(const ArrowSchema &schema) {
+  return Exception(std::string("unsupported Arrow format ") + schema.format);
+}
+
+/// adds a dictionary column to @p data
+void import_dictionary(RawData &data, const ArrowSchema &schema,
+                       const Validity &valid, const int64_t n) {
+  std::vector<std::string> strings;
+  switch (primitive_format(*schema.dictionary)) {
+  case 'u':
+    strings = import_strings<int32_t>(*valid.array.dictionary);
+    break;
+  case 'U':
+    strings = import_strings<int64_t>(*valid.array.dictionary);
+    break;
+  default:
+    throw unsupported_format(*schema.dictionary);
+  }
+
+  // the Arrow dictionary is not necessarily sorted (or unique), so map each
+  // index to the code of its string in the sorted dictionary
+  std::vector<std::string> dictionary = strings;
+  std::sort(dictionary.begin(), dictionary.end());
+  dictionary.erase(std::unique(dictionary.begin(), dictionary.end()),
+                   dictionary.end());
+
+  // codes are stored as floats, which are exact up to 2^24
+  if (dictionary.size() > (size_t(1) << 24)) {
+    throw Exception("too many unique strings to encode column");
+  }
+
+  std::vector<float> codes(strings.size());
+  std::transform(strings.begin(), strings.end(), codes.begin(),
+                 [&](const std::string &s) {
+                   return static_cast<float>(
+                       std::lower_bound(dictionary.begin(), dictionary.end(),
+                                        s) -
+                       dictionary.begin());
+                 });
+
+  std::vector<float> column;
+  switch (primitive_format(schema)) {
+  case 'c':
+    column = import_indices<int8_t>(valid, n, codes);
+    break;
+  case 'C':
+    column = import_indices<uint8_t>(valid, n, codes);
+    break;
+  case 's':
+    column = import_indices<int16_t>(valid, n, codes);
+    break;
+  case 'S':
+    column = import_indices<uint16_t>(valid, n, codes);
+    break;
+  case 'i':
+    column = import_indices<int32_t>(valid, n, codes);
+    break;
+  case 'I':
+    column = import_indices<uint32_t>(valid, n, codes);
+    break;
+  case 'l':
+    column = import_indices<int64_t>(valid, n, codes);
+    break;
+  case 'L':
+    column = import_indices<uint64_t>(valid, n, codes);
+    break;
+  default:
+    throw unsupported_format(schema);
+  }
+  data.add_column(Column(std::move(column)), std::move(dictionary));
+}
+
+/// adds the column given by @p schema and @p valid (which holds the array and
+/// the element of its buffers that the column starts at) to @p data. The
+/// column has @p n elements
+void import_column(RawData &data, const ArrowSchema &schema,
+                   const Validity &valid, const int64_t n,
+                   const std::shared_ptr<ArrowArray> &owner) {
+  if (schema.dictionary != nullptr) {
+    import_dictionary(data, schema, valid, n);
+    return;
+  }
+
+  switch (primitive_format(schema)) {
+  case 'f': {
+    const float *values =
+        static_cast<const float *>(valid.array.buffers[1]) + valid.offset;
+    if (!valid.has_nulls()) {
+      // no conversion needed, use the Arrow buffer directly
+      data.add_column(Column(values, static_cast<size_t>(n), 1, owner));
+    } else {
+      std::vector<float> column(static_cast<size_t>(n));
+      for (int64_t i = 0; i < n; ++i) {
+        column[i] =
+            valid(i) ? values[i] : std::numeric_limits<float>::quiet_NaN();
+      }
+      data.add_column(std::move(column));
+    }
+    break;
+  }
+  case 'g':
+    data.add_column(import_values<double>(valid, n));
+    break;
+  case 'c':
+    data.add_column(import_values<int8_t>(valid, n));
+    break;
+  case 'C':
+    data.add_column(import_values<uint8_t>(valid, n));
+    break;
+  case 's':
+    data.add_column(import_values<int16_t>(valid, n));
+    break;
+  case 'S':
+    data.add_column(import_values<uint16_t>(valid, n));
+    break;
+  case 'i':
+    data.add_column(import_values<int32_t>(valid, n));
+    break;
+  case 'I':
+    data.add_column(import_values<uint32_t>(valid, n));
+    break;
+  case 'l':
+    data.add_column(import_values<int64_t>(valid, n));
+    break;
+  case 'L':
+    data.add_column(import_values<uint64_t>(valid, n));
+    break;
+  default:
+    throw unsupported_format(schema);
+  }
+}
+
+} // namespace
+
+std::shared_ptr<RawData> import_arrow(const ArrowSchema *schema,
+                                      ArrowArray *array) {
+  // move the array into a shared pointer that releases it once the last
+  // column using its buffers is destroyed
+  std::shared_ptr<ArrowArray> owner(new ArrowArray(*array),
+                                    [](ArrowArray *a) {
+                                      if (a->release != nullptr) {
+                                        a->release(a);
+                                      }
+                                      delete a;
+                                    });
+  array->release = nullptr;
+
+  auto data = std::make_shared<RawData>();
+  if (std::strcmp(schema->format, "+s") == 0) {
+    // a struct, import each child as a column. The offset and validity
+    // bitmap of the struct apply to each of its children
+    for (int64_t i = 0; i < schema->n_children; ++i) {
+      const ArrowArray &child = *owner->children[i];
+      const Validity valid{child, owner->offset + child.offset, owner.get(),
+                           owner->offset};
+      import_column(*data, *schema->children[i], valid, owner->length, owner);
+    }
+  } else {
+    const Validity valid{*owner, owner->offset, nullptr, 0};
+    import_column(*data, *schema, valid, owner->length, owner);
+  }
+  return data;
+}
+
+} // namespace trase
@@ -0,0 +1,119 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file Arrow.hpp
+
+#ifndef ARROW_H_
+#define ARROW_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "frontend/Data.hpp"
+
+// The Arrow C data interface, see
+// https://arrow.apache.org/docs/format/CDataInterface.html. These structs are
+// part of the (stable) specification, so can be declared here without
+// depending on the Arrow library
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+  // Array type description
+  const char *format;
+  const char *name;
+  const char *metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema **children;
+  struct ArrowSchema *dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowSchema *);
+  // Opaque producer-specific data
+  void *private_data;
+};
+
+struct ArrowArray {
+  // Array data description
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void **buffers;
+  struct ArrowArray **children;
+  struct ArrowArray *dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowArray *);
+  // Opaque producer-specific data
+  void *private_data;
+};
+
+#endif // ARROW_C_DATA_INTERFACE
+
+namespace trase {
+
+/// imports Arrow data into a new RawData
+///
+/// If @p schema is a struct (e.g. an exported record batch) then each of its
+/// children becomes a column of the RawData, in order. Otherwise the array is
+/// imported as a single column. Supported column types are
+/// - float32 columns, which are used without copying
+/// - float64 and (signed or unsigned) integer columns, which are converted to
+///   offset encoded float columns (see Column::offset_encoded())
+/// - dictionary columns with integer indices and utf8 string values, which
+///   become dictionary encoded string columns (see RawData::string_data())
+///
+/// Null elements (given by the validity bitmap of a column, or of the struct
+/// it is a child of) are imported as NaN, and are ignored when calculating
+/// limits. A float32 column with nulls is therefore copied.
+///
+/// @param schema the type of @p array, this is only read and remains owned by
+/// the caller
+/// @param array the data, this is moved from (i.e. its release callback is set
+/// to nullptr). The imported columns share the buffers of the array, which is
+/// released when the last of them is destroyed
+///
+/// Throws trase::Exception if a column has an unsupported type
+std::shared_ptr<RawData> import_arrow(const ArrowSchema *schema,
+                                      ArrowArray *array);
+
+} // namespace trase
+
+#endif // ARROW_H_
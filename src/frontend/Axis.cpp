@@ -88,27 +88,28 @@ void Axis::update_tick_information() {
   vint2_t n_ticks = calculate_num_ticks();
 
   // Calculate ideal distance between ticks in limits coords
-  bfloat2_t xy_limits(
+  bbox<double, 2> xy_limits(
       {m_limits.bmin[Aesthetic::x::index], m_limits.bmin[Aesthetic::y::index]},
       {m_limits.bmax[Aesthetic::x::index], m_limits.bmax[Aesthetic::y::index]});
 
   // if any limits are empty (no values) use a sensible default (0 -> 1)
   for (int i = 0; i < 2; ++i) {
     if (xy_limits.bmax[i] < xy_limits.bmin[i]) {
-      xy_limits.bmin[i] = 0.f;
-      xy_limits.bmax[i] = 1.f;
+      xy_limits.bmin[i] = 0.0;
+      xy_limits.bmax[i] = 1.0;
     }
   }
 
   // work out a sensible spacing between ticks, based on the number of ticks
-  const vfloat2_t tick_dx =
-      round_off(xy_limits.delta() / n_ticks.cast<float>(), m_sig_digits);
+  const Vector<double, 2> tick_dx =
+      round_off(xy_limits.delta() / n_ticks.cast<double>(), m_sig_digits);
 
   // Idealise the lowest pick position
-  const vfloat2_t tick_min = ceil(xy_limits.bmin / tick_dx) * tick_dx;
+  const Vector<double, 2> tick_min = ceil(xy_limits.bmin / tick_dx) * tick_dx;
 
   // Adjust n_ticks due to round_off in tick_dx
-  vfloat2_t tick_max = tick_min + (n_ticks - 1).cast<float>() * tick_dx;
+  Vector<double, 2> tick_max =
+      tick_min + (n_ticks - 1).cast<double>() * tick_dx;
   for (int i = 0; i < 2; ++i) {
     while (tick_max[i] > xy_limits.bmax[i]) {
       --n_ticks[i];
@@ -122,7 +123,8 @@ void Axis::update_tick_information() {
 
   // scale to pixels
   const vfloat2_t tick_dx_pixels =
-      tick_dx * m_pixels.delta() / xy_limits.delta();
+      (tick_dx * m_pixels.delta().cast<double>() / xy_limits.delta())
+          .cast<float>();
   const vfloat2_t tick_min_pixels = {to_display<Aesthetic::x>(tick_min[0]),
                                      to_display<Aesthetic::y>(tick_min[1])};
 
@@ -53,8 +53,8 @@ class Legend;
 
 /// A helper struct for Axis that holds tick-related information
 struct TickInfo {
-  std::vector<float> x_val;
-  std::vector<float> y_val;
+  std::vector<double> x_val;
+  std::vector<double> y_val;
   std::vector<float> x_pos;
   std::vector<float> y_pos;
 
@@ -207,10 +207,36 @@ public:
 
   /// convert from data coordinates to display coordinates, using the given
   /// Aesthetic
-  template <typename Aesthetic> float to_display(float i) const {
+  template <typename Aesthetic> float to_display(double i) const {
     return Aesthetic::to_display(i, m_limits, m_pixels);
   }
 
+  /// convert the column of `data` for the given Aesthetic from data
+  /// coordinates to display coordinates, writing the result to `out` (which
+  /// must hold `data.rows()` elements)
+  template <typename Aesthetic>
+  void to_display(const DataWithAesthetic &data, float *out) const {
+    map<Aesthetic>().transform(data.begin<Aesthetic>(), data.end<Aesthetic>(),
+                               out);
+  }
+
+  /// as for to_display() above, but only converts the rows [`first`, `last`)
+  /// of `data`, writing the result to `out` (which must hold `last - first`
+  /// elements)
+  template <typename Aesthetic>
+  void to_display(const DataWithAesthetic &data, const size_t first,
+                  const size_t last, float *out) const {
+    const auto begin = data.begin<Aesthetic>();
+    map<Aesthetic>().transform(begin + static_cast<std::ptrdiff_t>(first),
+                               begin + static_cast<std::ptrdiff_t>(last), out);
+  }
+
+  /// returns the affine map from data coordinates to display coordinates for
+  /// the given Aesthetic, for mapping many points at once
+  template <typename Aesthetic> AffineMap map() const {
+    return Aesthetic::map(m_limits, m_pixels);
+  }
+
   /// set the number of ticks on this axis
   /// \param arg a length 2 int vector with the requested number of ticks along
   /// each axis (i.e. [x_ticks,y_ticks]). Setting the number of ticks on either
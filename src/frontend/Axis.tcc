@@ -87,7 +87,7 @@ template <typename Backend> void Axis::draw_common_ticks(Backend &backend) {
   // x ticks
   for (std::size_t i = 0; i < m_tick_info.x_pos.size(); ++i) {
     const float pos = m_tick_info.x_pos[i];
-    const float val = m_tick_info.x_val[i];
+    const double val = m_tick_info.x_val[i];
 
     backend.move_to(vfloat2_t(pos, m_pixels.bmax[1] + m_tick_len / 2));
     backend.line_to(vfloat2_t(pos, m_pixels.bmax[1]));
@@ -103,7 +103,7 @@ template <typename Backend> void Axis::draw_common_ticks(Backend &backend) {
   for (std::size_t i = 0; i < m_tick_info.y_pos.size(); ++i) {
 
     const float pos = m_tick_info.y_pos[i];
-    const float val = m_tick_info.y_val[i];
+    const double val = m_tick_info.y_val[i];
 
     backend.move_to(vfloat2_t(m_pixels.bmin[0] - m_tick_len / 2, pos));
     backend.line_to(vfloat2_t(m_pixels.bmin[0], pos));
@@ -33,83 +33,259 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "frontend/Data.hpp"
 
+#include <algorithm>
+
 namespace trase {
 
-template <>
-float cast_to_float<std::string>(const std::string &arg,
-                                 const std::set<std::string> &string_data) {
-  // if string_data is empty, then assume the string can be converted to a float
-  if (string_data.empty()) {
-    return std::stof(arg);
-  } else {
-    return static_cast<float>(
-        std::distance(string_data.begin(), string_data.find(arg)));
+void RawData::add_column(std::vector<float> &&new_col) {
+  add_column(Column(std::move(new_col)));
+}
+
+void RawData::set_capacity(const size_t capacity) {
+  ++m_version;
+  m_capacity = capacity;
+  for (auto &column : m_columns) {
+    column.set_capacity(capacity);
+  }
+  if (m_capacity && m_rows > m_capacity) {
+    m_rows = m_capacity;
+  }
+}
+
+void RawData::add_column(Column new_col) {
+  // check number of rows in new column match
+  if (m_cols > 0 && new_col.size() != m_rows) {
+    throw Exception("columns in dataset must have identical number of rows");
+  }
+  if (m_capacity) {
+    new_col.set_capacity(m_capacity);
+  }
+  if (m_cols == 0) {
+    m_rows = new_col.size();
   }
+  m_string_data.emplace_back();
+  m_columns.push_back(std::move(new_col));
+  ++m_cols;
+  ++m_version;
 }
 
-ColumnIterator RawData::begin(const int i) const {
-  if (i < 0 || i >= cols()) {
+std::shared_ptr<RawData>
+RawData::select(std::shared_ptr<const std::vector<size_t>> rows) const {
+  if (std::any_of(rows->begin(), rows->end(),
+                  [&](const size_t i) { return i >= m_rows; })) {
+    throw std::out_of_range("selected row out of range");
+  }
+  auto view = std::make_shared<RawData>();
+  view->reserve(m_cols);
+  for (size_t k = 0; k < m_cols; ++k) {
+    view->add_column(m_columns[k].select(rows));
+    view->m_string_data.back() = m_string_data[k];
+  }
+  return view;
+}
+
+void RawData::reserve(const size_t cols) {
+  m_columns.reserve(cols);
+  m_string_data.reserve(cols);
+}
+
+void RawData::add_column(Column new_col, std::vector<std::string> dictionary) {
+  if (!std::is_sorted(dictionary.begin(), dictionary.end())) {
+    throw Exception("column dictionary must be sorted");
+  }
+  add_column(std::move(new_col));
+  m_string_data.back() = share_dictionary(std::move(dictionary));
+}
+
+void RawData::set_column(const size_t i, std::vector<float> &&new_col) {
+  set_column(i, Column(std::move(new_col)));
+}
+
+void RawData::set_column(const size_t i, Column new_col) {
+  // check column exists
+  if (i >= cols()) {
+    throw std::out_of_range("column index out of range");
+  }
+
+  // check number of rows in new column match
+  if (new_col.size() != m_rows) {
+    throw Exception("columns in dataset must have identical number of rows");
+  }
+
+  if (m_capacity) {
+    new_col.set_capacity(m_capacity);
+  }
+  m_string_data[i].reset();
+  m_columns[i] = std::move(new_col);
+  ++m_version;
+}
+
+bool RawData::has_borrowed_columns() const {
+  return std::any_of(m_columns.begin(), m_columns.end(),
+                     [](const Column &column) { return column.is_borrowed(); });
+}
+
+void RawData::intern_columns(ColumnPool &pool) {
+  for (auto &column : m_columns) {
+    column = pool.intern(column);
+  }
+  ++m_version;
+}
+
+void RawData::quantise() {
+  for (size_t i = 0; i < m_cols; ++i) {
+    if (!m_string_data[i]) {
+      m_columns[i] = m_columns[i].quantised();
+    }
+  }
+  ++m_version;
+}
+
+ColumnIterator RawData::begin(const size_t i) const {
+  if (i >= cols()) {
     throw std::out_of_range("column does not exist");
   }
-  return {m_matrix.cbegin() + i, m_cols};
+  return m_columns[i].begin();
 }
 
-ColumnIterator RawData::end(const int i) const {
-  if (i < 0 || i >= cols()) {
+ColumnIterator RawData::end(const size_t i) const {
+  if (i >= cols()) {
     throw std::out_of_range("column does not exist");
   }
-  return {m_matrix.cend() + i, m_cols};
+  return m_columns[i].end();
 }
 
-const std::set<std::string> &RawData::string_data(int i) const {
-  return m_string_data[i];
+std::vector<double> RawData::decoded(const size_t i) const {
+  if (i >= cols()) {
+    throw std::out_of_range("column does not exist");
+  }
+  const auto column = m_columns[i].begin();
+  std::vector<double> values(m_rows);
+  for (size_t j = 0; j < m_rows; ++j) {
+    values[j] = column.decode(static_cast<std::ptrdiff_t>(j));
+  }
+  return values;
 }
 
-int DataWithAesthetic::rows() const { return m_data->rows(); }
+std::pair<float, float> RawData::minmax(const size_t i) const {
+  if (i >= cols()) {
+    throw std::out_of_range("column does not exist");
+  }
+  return m_columns[i].minmax();
+}
 
-int DataWithAesthetic::cols() const { return m_data->cols(); }
+std::pair<double, double> RawData::decoded_minmax(const size_t i) const {
+  if (i >= cols()) {
+    throw std::out_of_range("column does not exist");
+  }
+  return m_columns[i].decoded_minmax();
+}
 
-const Limits &DataWithAesthetic::limits() const { return m_limits; }
+bool RawData::is_sorted(const size_t i) const {
+  if (i >= cols()) {
+    throw std::out_of_range("column does not exist");
+  }
+  return m_columns[i].is_sorted();
+}
+
+size_t RawData::distinct(const size_t i) const {
+  if (i >= cols()) {
+    throw std::out_of_range("column does not exist");
+  }
+  return m_columns[i].distinct();
+}
+
+const std::vector<std::string> &RawData::string_data(size_t i) const {
+  static const std::vector<std::string> no_strings;
+  return m_string_data[i] ? *m_string_data[i] : no_strings;
+}
+
+std::shared_ptr<const std::vector<std::string>>
+RawData::share_dictionary(std::vector<std::string> &&dictionary) {
+  if (dictionary.empty()) {
+    return nullptr;
+  }
+  return std::make_shared<const std::vector<std::string>>(
+      std::move(dictionary));
+}
 
-template <typename Aesthetic> ColumnIterator DataWithAesthetic::begin() const {
+size_t DataWithAesthetic::rows() const { return m_data->rows(); }
 
-  auto search = m_map.find(Aesthetic::index);
+size_t DataWithAesthetic::cols() const { return m_data->cols(); }
 
-  if (search == m_map.end()) {
-    throw Exception(Aesthetic::name + std::string(" aestheic not provided"));
+const Limits &DataWithAesthetic::limits() const { return m_limits; }
+
+void DataWithAesthetic::set_capacity(const size_t capacity) {
+  m_data->set_capacity(capacity);
+  calculate_limits();
+}
+
+void DataWithAesthetic::intern_columns(ColumnPool &pool) {
+  if (m_data->capacity() || m_data->has_borrowed_columns()) {
+    return;
   }
-  return m_data->begin(search->second);
+  // copies the column handles and dictionary pointers, not the data
+  m_data = std::make_shared<RawData>(*m_data);
+  m_data->intern_columns(pool);
+  m_columns_version = npos;
 }
 
-template <typename Aesthetic> ColumnIterator DataWithAesthetic::end() const {
+void DataWithAesthetic::quantise() {
+  m_data = std::make_shared<RawData>(*m_data);
+  m_data->quantise();
+  m_columns_version = npos;
+  calculate_limits();
+}
 
-  auto search = m_map.find(Aesthetic::index);
+const size_t DataWithAesthetic::npos;
 
-  if (search == m_map.end()) {
-    throw Exception(Aesthetic::name + std::string(" aestheic not provided"));
+void DataWithAesthetic::cache_columns() const {
+  for (size_t i = 0; i < m_map.size(); ++i) {
+    if (m_map[i] != npos) {
+      m_begin[i] = m_data->begin(m_map[i]);
+      m_end[i] = m_data->end(m_map[i]);
+    }
   }
-  return m_data->end(search->second);
-}
-
-template ColumnIterator DataWithAesthetic::begin<Aesthetic::x>() const;
-template ColumnIterator DataWithAesthetic::begin<Aesthetic::y>() const;
-template ColumnIterator DataWithAesthetic::begin<Aesthetic::color>() const;
-template ColumnIterator DataWithAesthetic::begin<Aesthetic::size>() const;
-template ColumnIterator DataWithAesthetic::begin<Aesthetic::fill>() const;
-template ColumnIterator DataWithAesthetic::begin<Aesthetic::xmin>() const;
-template ColumnIterator DataWithAesthetic::begin<Aesthetic::ymin>() const;
-template ColumnIterator DataWithAesthetic::begin<Aesthetic::xmax>() const;
-template ColumnIterator DataWithAesthetic::begin<Aesthetic::ymax>() const;
-
-template ColumnIterator DataWithAesthetic::end<Aesthetic::x>() const;
-template ColumnIterator DataWithAesthetic::end<Aesthetic::y>() const;
-template ColumnIterator DataWithAesthetic::end<Aesthetic::color>() const;
-template ColumnIterator DataWithAesthetic::end<Aesthetic::size>() const;
-template ColumnIterator DataWithAesthetic::end<Aesthetic::fill>() const;
-template ColumnIterator DataWithAesthetic::end<Aesthetic::xmin>() const;
-template ColumnIterator DataWithAesthetic::end<Aesthetic::ymin>() const;
-template ColumnIterator DataWithAesthetic::end<Aesthetic::xmax>() const;
-template ColumnIterator DataWithAesthetic::end<Aesthetic::ymax>() const;
+  m_columns_version = m_data->version();
+}
+
+void DataWithAesthetic::calculate_limits() {
+  for (int i = 0; i < Aesthetic::N; ++i) {
+    const size_t column = m_map[i];
+    if (column == npos) {
+      continue;
+    }
+    switch (i) {
+    case Aesthetic::x::index:
+      calculate_limits<Aesthetic::x>(column);
+      break;
+    case Aesthetic::y::index:
+      calculate_limits<Aesthetic::y>(column);
+      break;
+    case Aesthetic::color::index:
+      calculate_limits<Aesthetic::color>(column);
+      break;
+    case Aesthetic::size::index:
+      calculate_limits<Aesthetic::size>(column);
+      break;
+    case Aesthetic::fill::index:
+      calculate_limits<Aesthetic::fill>(column);
+      break;
+    case Aesthetic::xmin::index:
+      calculate_limits<Aesthetic::xmin>(column);
+      break;
+    case Aesthetic::ymin::index:
+      calculate_limits<Aesthetic::ymin>(column);
+      break;
+    case Aesthetic::xmax::index:
+      calculate_limits<Aesthetic::xmax>(column);
+      break;
+    case Aesthetic::ymax::index:
+      calculate_limits<Aesthetic::ymax>(column);
+      break;
+    }
+  }
+}
 
 const int Aesthetic::N;
 const int Aesthetic::x::index;
@@ -131,227 +307,279 @@ const char *Aesthetic::xmax::name = "xmax";
 const int Aesthetic::ymax::index;
 const char *Aesthetic::ymax::name = "ymax";
 
-float Aesthetic::x::to_display(const float data, const Limits &data_lim,
-                               const bfloat2_t &display_lim) {
-  float len_ratio = (display_lim.bmax[0] - display_lim.bmin[0]) /
-                    (data_lim.bmax[index] - data_lim.bmin[index]);
-
-  float rel_pos = data - data_lim.bmin[index];
-  return display_lim.bmin[0] + rel_pos * len_ratio;
-}
-
 float Aesthetic::x::from_display(const float display, const Limits &data_lim,
                                  const bfloat2_t &display_lim) {
-  float len_ratio = (data_lim.bmax[index] - data_lim.bmin[index]) /
-                    (display_lim.bmax[1] - display_lim.bmin[1]);
+  double len_ratio = (data_lim.bmax[index] - data_lim.bmin[index]) /
+                     (display_lim.bmax[1] - display_lim.bmin[1]);
 
   float rel_pos = display - display_lim.bmin[1];
   return data_lim.bmin[index] + rel_pos * len_ratio;
 }
 
-/// the data to display on the y-axis of the plot
-float Aesthetic::y::to_display(const float data, const Limits &data_lim,
-                               const bfloat2_t &display_lim) {
-  float len_ratio = (display_lim.bmax[1] - display_lim.bmin[1]) /
-                    (data_lim.bmax[index] - data_lim.bmin[index]);
-
-  // Get the relative position and invert y by default (e.g. limits->pixels)
-  float rel_pos = data_lim.bmax[index] - data;
-  return display_lim.bmin[1] + rel_pos * len_ratio;
-}
-
 float Aesthetic::y::from_display(const float display, const Limits &data_lim,
                                  const bfloat2_t &display_lim) {
-  float len_ratio = (data_lim.bmax[index] - data_lim.bmin[index]) /
-                    (display_lim.bmax[1] - display_lim.bmin[1]);
+  double len_ratio = (data_lim.bmax[index] - data_lim.bmin[index]) /
+                     (display_lim.bmax[1] - display_lim.bmin[1]);
 
   float rel_pos = display_lim.bmax[1] - display;
   return data_lim.bmin[index] + rel_pos * len_ratio;
 }
 
-float Aesthetic::color::to_display(const float data, const Limits &data_lim,
-                                   const bfloat2_t &display_lim) {
-  (void)display_lim;
-  float len_ratio = 1.f / (data_lim.bmax[index] - data_lim.bmin[index]);
-
-  float rel_pos = data - data_lim.bmin[index];
-  return rel_pos * len_ratio;
-}
-
 float Aesthetic::color::from_display(const float display,
                                      const Limits &data_lim,
                                      const bfloat2_t &display_lim) {
   (void)display_lim;
-  float len_ratio = (data_lim.bmax[index] - data_lim.bmin[index]);
+  double len_ratio = (data_lim.bmax[index] - data_lim.bmin[index]);
 
   float rel_pos = display;
   return data_lim.bmin[index] + rel_pos * len_ratio;
 }
 
-float Aesthetic::size::to_display(const float data, const Limits &data_lim,
-                                  const bfloat2_t &display_lim) {
-  float len_ratio = 0.05f * (display_lim.bmax[1] - display_lim.bmin[1]) /
-                    (data_lim.bmax[index] - data_lim.bmin[index]);
-
-  float rel_pos = data - data_lim.bmin[index];
-  return 1.f + rel_pos * len_ratio;
-}
-
 float Aesthetic::size::from_display(const float display, const Limits &data_lim,
                                     const bfloat2_t &display_lim) {
-  float len_ratio = 20.f * (data_lim.bmax[index] - data_lim.bmin[index]) /
-                    (display_lim.bmax[1] - display_lim.bmin[1]);
+  double len_ratio = 20.f * (data_lim.bmax[index] - data_lim.bmin[index]) /
+                     (display_lim.bmax[1] - display_lim.bmin[1]);
 
   float rel_pos = display - 1.f;
   return data_lim.bmin[index] + rel_pos * len_ratio;
 }
 
-float Aesthetic::fill::to_display(const float data, const Limits &data_lim,
-                                  const bfloat2_t &display_lim) {
-  (void)display_lim;
-  float len_ratio = 1.f / (data_lim.bmax[index] - data_lim.bmin[index]);
-
-  float rel_pos = data - data_lim.bmin[index];
-  return rel_pos * len_ratio;
-}
-
 float Aesthetic::fill::from_display(const float display, const Limits &data_lim,
                                     const bfloat2_t &display_lim) {
   (void)display_lim;
-  float len_ratio = (data_lim.bmax[index] - data_lim.bmin[index]);
+  double len_ratio = (data_lim.bmax[index] - data_lim.bmin[index]);
 
   float rel_pos = display;
   return data_lim.bmin[index] + rel_pos * len_ratio;
 }
 
-float Aesthetic::xmin::to_display(const float data, const Limits &data_lim,
-                                  const bfloat2_t &display_lim) {
-  const int xindex = Aesthetic::x::index;
-  float len_ratio = (display_lim.bmax[0] - display_lim.bmin[0]) /
-                    (data_lim.bmax[xindex] - data_lim.bmin[xindex]);
-
-  float rel_pos = data - data_lim.bmin[xindex];
-  return display_lim.bmin[0] + rel_pos * len_ratio;
-}
-
 float Aesthetic::xmin::from_display(const float display, const Limits &data_lim,
                                     const bfloat2_t &display_lim) {
   const int xindex = Aesthetic::x::index;
-  float len_ratio = (data_lim.bmax[xindex] - data_lim.bmin[xindex]) /
-                    (display_lim.bmax[1] - display_lim.bmin[1]);
+  double len_ratio = (data_lim.bmax[xindex] - data_lim.bmin[xindex]) /
+                     (display_lim.bmax[1] - display_lim.bmin[1]);
 
   float rel_pos = display - display_lim.bmin[1];
   return data_lim.bmin[xindex] + rel_pos * len_ratio;
 }
 
-/// the data to display on the y-axis of the plot
-float Aesthetic::ymin::to_display(const float data, const Limits &data_lim,
-                                  const bfloat2_t &display_lim) {
-  const int yindex = Aesthetic::y::index;
-  float len_ratio = (display_lim.bmax[1] - display_lim.bmin[1]) /
-                    (data_lim.bmax[yindex] - data_lim.bmin[yindex]);
-
-  // Get the relative position and invert y by default (e.g. limits->pixels)
-  float rel_pos = data_lim.bmax[yindex] - data;
-  return display_lim.bmin[1] + rel_pos * len_ratio;
-}
-
 float Aesthetic::ymin::from_display(const float display, const Limits &data_lim,
                                     const bfloat2_t &display_lim) {
   const int yindex = Aesthetic::y::index;
-  float len_ratio = (data_lim.bmax[yindex] - data_lim.bmin[yindex]) /
-                    (display_lim.bmax[1] - display_lim.bmin[1]);
+  double len_ratio = (data_lim.bmax[yindex] - data_lim.bmin[yindex]) /
+                     (display_lim.bmax[1] - display_lim.bmin[1]);
 
   float rel_pos = display_lim.bmax[1] - display;
   return data_lim.bmin[yindex] + rel_pos * len_ratio;
 }
 
-float Aesthetic::xmax::to_display(const float data, const Limits &data_lim,
-                                  const bfloat2_t &display_lim) {
-  return Aesthetic::xmin::to_display(data, data_lim, display_lim);
-}
-
 float Aesthetic::xmax::from_display(const float display, const Limits &data_lim,
                                     const bfloat2_t &display_lim) {
   return Aesthetic::xmin::from_display(display, data_lim, display_lim);
 }
 
-/// the data to display on the y-axis of the plot
-float Aesthetic::ymax::to_display(const float data, const Limits &data_lim,
-                                  const bfloat2_t &display_lim) {
-  return Aesthetic::ymin::to_display(data, data_lim, display_lim);
-}
-
 float Aesthetic::ymax::from_display(const float display, const Limits &data_lim,
                                     const bfloat2_t &display_lim) {
   return Aesthetic::ymin::from_display(display, data_lim, display_lim);
 }
 
 template <>
-void DataWithAesthetic::set<Aesthetic::xmin>(const float min, const float max) {
+void DataWithAesthetic::set<Aesthetic::xmin>(const double min,
+                                             const double max) {
   m_limits.bmin[Aesthetic::x::index] = min;
 }
 
 template <>
-void DataWithAesthetic::set<Aesthetic::xmax>(const float min, const float max) {
+void DataWithAesthetic::set<Aesthetic::xmax>(const double min,
+                                             const double max) {
   m_limits.bmax[Aesthetic::x::index] = max;
 }
 
 template <>
-void DataWithAesthetic::set<Aesthetic::ymin>(const float min, const float max) {
+void DataWithAesthetic::set<Aesthetic::ymin>(const double min,
+                                             const double max) {
   m_limits.bmin[Aesthetic::y::index] = min;
 }
 
 template <>
-void DataWithAesthetic::set<Aesthetic::ymax>(const float min, const float max) {
+void DataWithAesthetic::set<Aesthetic::ymax>(const double min,
+                                             const double max) {
   m_limits.bmax[Aesthetic::y::index] = max;
 }
 
-DataWithAesthetic &DataWithAesthetic::x(const float min, const float max) {
+DataWithAesthetic &DataWithAesthetic::x(const double min, const double max) {
   set<Aesthetic::x>(min, max);
   return *this;
 }
 
-DataWithAesthetic &DataWithAesthetic::y(const float min, const float max) {
+DataWithAesthetic &DataWithAesthetic::y(const double min, const double max) {
   set<Aesthetic::y>(min, max);
   return *this;
 }
 
-DataWithAesthetic &DataWithAesthetic::color(const float min, const float max) {
+DataWithAesthetic &DataWithAesthetic::color(const double min,
+                                            const double max) {
   set<Aesthetic::color>(min, max);
   return *this;
 }
 
-DataWithAesthetic &DataWithAesthetic::size(const float min, const float max) {
+DataWithAesthetic &DataWithAesthetic::size(const double min, const double max) {
   set<Aesthetic::size>(min, max);
   return *this;
 }
 
-DataWithAesthetic &DataWithAesthetic::fill(const float min, const float max) {
+DataWithAesthetic &DataWithAesthetic::fill(const double min, const double max) {
   set<Aesthetic::fill>(min, max);
   return *this;
 }
 
-DataWithAesthetic &DataWithAesthetic::xmin(const float min, const float max) {
+DataWithAesthetic &DataWithAesthetic::xmin(const double min, const double max) {
   set<Aesthetic::xmin>(min, max);
   return *this;
 }
 
-DataWithAesthetic &DataWithAesthetic::ymin(const float min, const float max) {
+DataWithAesthetic &DataWithAesthetic::ymin(const double min, const double max) {
   set<Aesthetic::ymin>(min, max);
   return *this;
 }
 
-DataWithAesthetic &DataWithAesthetic::xmax(const float min, const float max) {
+DataWithAesthetic &DataWithAesthetic::xmax(const double min, const double max) {
   set<Aesthetic::xmax>(min, max);
   return *this;
 }
 
-DataWithAesthetic &DataWithAesthetic::ymax(const float min, const float max) {
+DataWithAesthetic &DataWithAesthetic::ymax(const double min, const double max) {
   set<Aesthetic::ymax>(min, max);
   return *this;
 }
 
+DataWithAesthetic &DataWithAesthetic::x(std::vector<float> &&data) {
+  set<Aesthetic::x>(std::move(data));
+  return *this;
+}
+
+DataWithAesthetic &DataWithAesthetic::x(Column data) {
+  set<Aesthetic::x>(std::move(data));
+  return *this;
+}
+
+DataWithAesthetic &DataWithAesthetic::y(std::vector<float> &&data) {
+  set<Aesthetic::y>(std::move(data));
+  return *this;
+}
+
+DataWithAesthetic &DataWithAesthetic::y(Column data) {
+  set<Aesthetic::y>(std::move(data));
+  return *this;
+}
+
+DataWithAesthetic &DataWithAesthetic::color(std::vector<float> &&data) {
+  set<Aesthetic::color>(std::move(data));
+  return *this;
+}
+
+DataWithAesthetic &DataWithAesthetic::color(Column data) {
+  set<Aesthetic::color>(std::move(data));
+  return *this;
+}
+
+DataWithAesthetic &DataWithAesthetic::size(std::vector<float> &&data) {
+  set<Aesthetic::size>(std::move(data));
+  return *this;
+}
+
+DataWithAesthetic &DataWithAesthetic::size(Column data) {
+  set<Aesthetic::size>(std::move(data));
+  return *this;
+}
+
+DataWithAesthetic &DataWithAesthetic::fill(std::vector<float> &&data) {
+  set<Aesthetic::fill>(std::move(data));
+  return *this;
+}
+
+DataWithAesthetic &DataWithAesthetic::fill(Column data) {
+  set<Aesthetic::fill>(std::move(data));
+  return *this;
+}
+
+DataWithAesthetic &DataWithAesthetic::xmin(std::vector<float> &&data) {
+  set<Aesthetic::xmin>(std::move(data));
+  return *this;
+}
+
+DataWithAesthetic &DataWithAesthetic::xmin(Column data) {
+  set<Aesthetic::xmin>(std::move(data));
+  return *this;
+}
+
+DataWithAesthetic &DataWithAesthetic::ymin(std::vector<float> &&data) {
+  set<Aesthetic::ymin>(std::move(data));
+  return *this;
+}
+
+DataWithAesthetic &DataWithAesthetic::ymin(Column data) {
+  set<Aesthetic::ymin>(std::move(data));
+  return *this;
+}
+
+DataWithAesthetic &DataWithAesthetic::xmax(std::vector<float> &&data) {
+  set<Aesthetic::xmax>(std::move(data));
+  return *this;
+}
+
+DataWithAesthetic &DataWithAesthetic::xmax(Column data) {
+  set<Aesthetic::xmax>(std::move(data));
+  return *this;
+}
+
+DataWithAesthetic &DataWithAesthetic::ymax(std::vector<float> &&data) {
+  set<Aesthetic::ymax>(std::move(data));
+  return *this;
+}
+
+DataWithAesthetic &DataWithAesthetic::ymax(Column data) {
+  set<Aesthetic::ymax>(std::move(data));
+  return *this;
+}
+
 DataWithAesthetic create_data() { return DataWithAesthetic(); }
 
+DataWithAesthetic DataWithAesthetic::select(
+    std::shared_ptr<const std::vector<size_t>> rows) const {
+  return DataWithAesthetic(m_data->select(std::move(rows)), m_map, m_limits);
+}
+
+DataWithAesthetic DataBuilder::build() {
+  // check all the rows before adding any columns
+  size_t cols = 0;
+  size_t rows = 0;
+  for (size_t i = 0; i < m_columns.size(); ++i) {
+    if (m_set[i]) {
+      if (cols > 0 && m_columns[i].size() != rows) {
+        throw Exception(
+            "columns in dataset must have identical number of rows");
+      }
+      rows = m_columns[i].size();
+      ++cols;
+    }
+  }
+
+  auto data = std::make_shared<RawData>();
+  data->reserve(cols);
+  AestheticMap map;
+  map.fill(DataWithAesthetic::npos);
+  for (size_t i = 0; i < m_columns.size(); ++i) {
+    if (m_set[i]) {
+      data->add_column(std::move(m_columns[i]), std::move(m_string_data[i]));
+      map[i] = data->cols() - 1;
+    }
+  }
+
+  DataWithAesthetic result(std::move(data), map, Limits());
+  result.calculate_limits();
+  m_set.fill(false);
+  return result;
+}
+
 } // namespace trase
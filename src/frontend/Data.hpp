@@ -37,41 +37,89 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef DATA_H_
 #define DATA_H_
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <functional>
+#include <array>
+#include <iterator>
+#include <limits>
 #include <map>
 #include <memory>
-#include <set>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "util/AffineMap.hpp"
 #include "util/BBox.hpp"
 #include "util/Colors.hpp"
+#include "util/Column.hpp"
 #include "util/ColumnIterator.hpp"
+#include "util/ColumnPool.hpp"
 #include "util/Exception.hpp"
 
 namespace trase {
 
-/// Raw data class, impliments a matrix with row major order
+/// Raw data class, impliments a matrix with column major order
+///
+/// Each column is held in its own buffer (see Column), so adding or replacing a
+/// column only touches the data in that column. Columns can also refer to
+/// externally owned buffers, in which case the data is not copied
+///
+/// A dataset can be given a fixed capacity (see set_capacity()), in which case
+/// each column is a ring buffer and adding a row to a full dataset drops the
+/// oldest row. This is useful for live data, e.g. the last N samples of a
+/// stream. Note that a plot does not follow the limits of a live data set,
+/// see Geometry::add_frame()
 class RawData {
-  // raw data set, in row major order
-  std::vector<float> m_matrix;
+  // raw data set, one buffer per column
+  std::vector<Column> m_columns;
+
+  // sorted dictionaries for non-numeric string data, nullptr for numeric
+  // columns. These are shared by copies and views of the data set
+  std::vector<std::shared_ptr<const std::vector<std::string>>> m_string_data;
 
-  // sets for non-numeric string data
-  std::vector<std::set<std::string>> m_string_data;
+  size_t m_rows{0};
+  size_t m_cols{0};
 
-  /// temporary data
-  std::vector<float> m_tmp;
+  // maximum number of rows, 0 if unbounded
+  size_t m_capacity{0};
 
-  int m_rows{0};
-  int m_cols{0};
+  // incremented whenever the data is modified
+  size_t m_version{0};
+
+  // returns @p dictionary to store in m_string_data, nullptr if it is empty
+  static std::shared_ptr<const std::vector<std::string>>
+  share_dictionary(std::vector<std::string> &&dictionary);
 
 public:
   /// return the number of columns
-  int cols() const { return m_cols; };
+  size_t cols() const { return m_cols; };
 
   /// return the number of rows
-  int rows() const { return m_rows; };
+  size_t rows() const { return m_rows; };
+
+  /// return the maximum number of rows, or 0 if the number of rows is
+  /// unbounded
+  size_t capacity() const { return m_capacity; };
+
+  /// return the version of the data, this changes whenever the data is
+  /// modified (so iterators to the columns might be invalidated)
+  size_t version() const { return m_version; };
+
+  /// returns true if any column refers to an externally owned buffer, see
+  /// Column::is_borrowed()
+  bool has_borrowed_columns() const;
+
+  /// set the maximum number of rows. If there are more rows than this then
+  /// only the last `capacity` rows are kept. Once full, adding a new row drops
+  /// the oldest row. A capacity of 0 (the default) means that the number of
+  /// rows is unbounded
+  void set_capacity(size_t capacity);
 
   /// add a new column to the matrix using begin/end iterators. the data is
   /// copied into the new column
@@ -89,20 +137,86 @@ public:
   /// new row
   template <typename T> void add_row(const std::vector<T> &new_row);
 
+  /// add a number of new rows to the matrix. `new_rows` holds the rows one
+  /// after the other, so its size must be a multiple of the number of columns
+  template <typename T> void add_rows(const std::vector<T> &new_rows);
+
+  /// add a new column to the matrix. `new_col` is moved into the new column
+  /// without copying
+  void add_column(std::vector<float> &&new_col);
+
+  /// add a new column to the matrix. `new_col` is stored as is, so a borrowed
+  /// column is not copied
+  void add_column(Column new_col);
+
+  /// reserve space for @p cols columns, so that adding them does not
+  /// reallocate
+  void reserve(size_t cols);
+
+  /// add a new dictionary encoded column to the matrix. Each element of
+  /// `new_col` is the index of a string in `dictionary`, which must be sorted
+  /// (see string_data())
+  void add_column(Column new_col, std::vector<std::string> dictionary);
+
   /// set a column in the matrix. the data in `new_col` is copied into column
   /// i
-  template <typename T> void set_column(int i, const std::vector<T> &new_col);
+  template <typename T>
+  void set_column(size_t i, const std::vector<T> &new_col);
+
+  /// set a column in the matrix. `new_col` is moved into column i without
+  /// copying
+  void set_column(size_t i, std::vector<float> &&new_col);
+
+  /// set a column in the matrix. `new_col` is stored as is, so a borrowed
+  /// column is not copied
+  void set_column(size_t i, Column new_col);
+
+  /// replaces each column with the identical column in @p pool, so that
+  /// columns with the same contents share a single buffer (see ColumnPool).
+  /// Columns not yet in the pool are added to it
+  void intern_columns(ColumnPool &pool);
+
+  /// quantises each numeric column to 16 bits, see Column::quantised().
+  /// Dictionary encoded string columns are not quantised, so that each of
+  /// their elements still refers to the same string
+  void quantise();
 
   /// return a ColumnIterator to the beginning of column i
-  ColumnIterator begin(int i) const;
+  ColumnIterator begin(size_t i) const;
 
   /// return a ColumnIterator to the end of column i
-  ColumnIterator end(int i) const;
+  ColumnIterator end(size_t i) const;
+
+  /// return the decoded (i.e. offset + stored, see Column) values of column i,
+  /// e.g. to facet the data set on them
+  std::vector<double> decoded(size_t i) const;
+
+  /// return the min/max of the stored (i.e. not decoded, see Column) values
+  /// of column i, which must not be empty
+  std::pair<float, float> minmax(size_t i) const;
+
+  /// return the min/max of the decoded values of column i, which must not be
+  /// empty, see Column::decoded_minmax()
+  std::pair<double, double> decoded_minmax(size_t i) const;
 
-  /// return the set of strings for column i
+  /// returns true if the values of column i are sorted in non-decreasing
+  /// order, see Column::is_sorted()
   ///
-  /// the returned set will be empty if column i contains numeric data
-  const std::set<std::string> &string_data(int i) const;
+  /// as for minmax(), this is cached by the column and kept up to date as rows
+  /// are added, so is cheap to call before choosing an algorithm (e.g. a binary
+  /// search on a sorted column)
+  bool is_sorted(size_t i) const;
+
+  /// returns the number of distinct values in column i, see
+  /// Column::distinct(). This is cached in the same way as is_sorted()
+  size_t distinct(size_t i) const;
+
+  /// return the dictionary of strings for column i
+  ///
+  /// columns of non-numeric strings are dictionary encoded, each element of
+  /// the column is the index of its string in the returned (sorted) vector.
+  /// The returned vector will be empty if column i contains numeric data
+  const std::vector<std::string> &string_data(size_t i) const;
 
   /// facets the data based on the input data column
   ///
@@ -120,6 +234,44 @@ public:
   template <typename T1, typename T2>
   std::map<std::pair<T1, T2>, std::shared_ptr<RawData>>
   facet(const std::vector<T1> &data1, const std::vector<T2> &data2) const;
+
+  /// facets the data based on the input data column, as for facet(), but
+  /// each facet is a view that selects rows of this dataset rather than a
+  /// copy
+  ///
+  /// the views share the column buffers of this dataset, so only one row index
+  /// per row is stored in total
+  template <typename T>
+  std::map<T, std::shared_ptr<RawData>>
+  facet_view(const std::vector<T> &data) const;
+
+  /// facets the data based on the dual input data columns, as for facet(),
+  /// but each facet is a view that selects rows of this dataset rather than a
+  /// copy
+  template <typename T1, typename T2>
+  std::map<std::pair<T1, T2>, std::shared_ptr<RawData>>
+  facet_view(const std::vector<T1> &data1, const std::vector<T2> &data2) const;
+
+  /// returns a view of the given @p rows of this dataset, which must all be
+  /// less than rows(). The view shares the column buffers of this dataset
+  std::shared_ptr<RawData>
+  select(std::shared_ptr<const std::vector<size_t>> rows) const;
+
+  /// returns a view (see select()) of the rows i for which `predicate(i)` is
+  /// true
+  template <typename Predicate>
+  std::shared_ptr<RawData> filter(Predicate predicate) const;
+
+private:
+  /// facets the data using key(i) as the key for row i
+  ///
+  /// rows are grouped in a single hashing pass. If @p view is true each facet
+  /// selects its rows from this dataset, otherwise the rows are scattered
+  /// column by column into one preallocated buffer per facet. Either way
+  /// the facets share the string dictionaries of this dataset
+  template <typename Key, typename KeyFunction>
+  std::map<Key, std::shared_ptr<RawData>> facet_by(KeyFunction key,
+                                                   bool view) const;
 };
 
 /// Aesthetics are a collection of tag classes that represent each aesthetic
@@ -133,14 +285,17 @@ struct Aesthetic {
 
   /// all aethetics except for xmin,ymin,xmax,ymax have their own min/max
   /// bounds
-  using Limits = bbox<float, N - 4>;
+  using Limits = bbox<double, N - 4>;
 
   /// the data to display on the x-axis of the plot
   struct x {
     static const int index = 0;
     static const char *name;
-    static float to_display(float data, const Limits &data_lim,
-                            const bfloat2_t &display_lim);
+    static AffineMap map(const Limits &data_lim, const bfloat2_t &display_lim);
+    static float to_display(double data, const Limits &data_lim,
+                            const bfloat2_t &display_lim) {
+      return map(data_lim, display_lim)(data);
+    }
     static float from_display(float display, const Limits &data_lim,
                               const bfloat2_t &display_lim);
   };
@@ -149,8 +304,11 @@ struct Aesthetic {
   struct y {
     static const int index = 1;
     static const char *name;
-    static float to_display(float data, const Limits &data_lim,
-                            const bfloat2_t &display_lim);
+    static AffineMap map(const Limits &data_lim, const bfloat2_t &display_lim);
+    static float to_display(double data, const Limits &data_lim,
+                            const bfloat2_t &display_lim) {
+      return map(data_lim, display_lim)(data);
+    }
     static float from_display(float display, const Limits &data_lim,
                               const bfloat2_t &display_lim);
   };
@@ -160,8 +318,11 @@ struct Aesthetic {
     static const int index = 2;
     static const char *name;
 
-    static float to_display(float data, const Limits &data_lim,
-                            const bfloat2_t &display_lim);
+    static AffineMap map(const Limits &data_lim, const bfloat2_t &display_lim);
+    static float to_display(double data, const Limits &data_lim,
+                            const bfloat2_t &display_lim) {
+      return map(data_lim, display_lim)(data);
+    }
     static float from_display(float display, const Limits &data_lim,
                               const bfloat2_t &display_lim);
   };
@@ -172,8 +333,11 @@ struct Aesthetic {
     static const int index = 3;
     static const char *name;
 
-    static float to_display(float data, const Limits &data_lim,
-                            const bfloat2_t &display_lim);
+    static AffineMap map(const Limits &data_lim, const bfloat2_t &display_lim);
+    static float to_display(double data, const Limits &data_lim,
+                            const bfloat2_t &display_lim) {
+      return map(data_lim, display_lim)(data);
+    }
     static float from_display(float display, const Limits &data_lim,
                               const bfloat2_t &display_lim);
   };
@@ -183,8 +347,11 @@ struct Aesthetic {
     static const int index = 4;
     static const char *name;
 
-    static float to_display(float data, const Limits &data_lim,
-                            const bfloat2_t &display_lim);
+    static AffineMap map(const Limits &data_lim, const bfloat2_t &display_lim);
+    static float to_display(double data, const Limits &data_lim,
+                            const bfloat2_t &display_lim) {
+      return map(data_lim, display_lim)(data);
+    }
     static float from_display(float display, const Limits &data_lim,
                               const bfloat2_t &display_lim);
   };
@@ -196,8 +363,11 @@ struct Aesthetic {
   struct xmin {
     static const int index = 5;
     static const char *name;
-    static float to_display(float data, const Limits &data_lim,
-                            const bfloat2_t &display_lim);
+    static AffineMap map(const Limits &data_lim, const bfloat2_t &display_lim);
+    static float to_display(double data, const Limits &data_lim,
+                            const bfloat2_t &display_lim) {
+      return map(data_lim, display_lim)(data);
+    }
     static float from_display(float display, const Limits &data_lim,
                               const bfloat2_t &display_lim);
   };
@@ -206,8 +376,11 @@ struct Aesthetic {
   struct ymin {
     static const int index = 6;
     static const char *name;
-    static float to_display(float data, const Limits &data_lim,
-                            const bfloat2_t &display_lim);
+    static AffineMap map(const Limits &data_lim, const bfloat2_t &display_lim);
+    static float to_display(double data, const Limits &data_lim,
+                            const bfloat2_t &display_lim) {
+      return map(data_lim, display_lim)(data);
+    }
     static float from_display(float display, const Limits &data_lim,
                               const bfloat2_t &display_lim);
   };
@@ -216,8 +389,11 @@ struct Aesthetic {
   struct xmax {
     static const int index = 7;
     static const char *name;
-    static float to_display(float data, const Limits &data_lim,
-                            const bfloat2_t &display_lim);
+    static AffineMap map(const Limits &data_lim, const bfloat2_t &display_lim);
+    static float to_display(double data, const Limits &data_lim,
+                            const bfloat2_t &display_lim) {
+      return map(data_lim, display_lim)(data);
+    }
     static float from_display(float display, const Limits &data_lim,
                               const bfloat2_t &display_lim);
   };
@@ -226,8 +402,11 @@ struct Aesthetic {
   struct ymax {
     static const int index = 8;
     static const char *name;
-    static float to_display(float data, const Limits &data_lim,
-                            const bfloat2_t &display_lim);
+    static AffineMap map(const Limits &data_lim, const bfloat2_t &display_lim);
+    static float to_display(double data, const Limits &data_lim,
+                            const bfloat2_t &display_lim) {
+      return map(data_lim, display_lim)(data);
+    }
     static float from_display(float display, const Limits &data_lim,
                               const bfloat2_t &display_lim);
   };
@@ -237,29 +416,115 @@ struct Aesthetic {
 /// limits, or scales, that are used for plotting
 using Limits = Aesthetic::Limits;
 
+// the affine maps from data to display coordinates for each aesthetic. x
+// maps to the horizontal display axis, y maps to the vertical display axis
+// inverted (e.g. limits->pixels), color and fill map to [0, 1] and size maps
+// to a radius starting at 1
+inline AffineMap Aesthetic::x::map(const Limits &data_lim,
+                                   const bfloat2_t &display_lim) {
+  return {data_lim.bmin[index],
+          static_cast<float>((display_lim.bmax[0] - display_lim.bmin[0]) /
+                             (data_lim.bmax[index] - data_lim.bmin[index])),
+          display_lim.bmin[0]};
+}
+
+inline AffineMap Aesthetic::y::map(const Limits &data_lim,
+                                   const bfloat2_t &display_lim) {
+  return {data_lim.bmax[index],
+          static_cast<float>(-(display_lim.bmax[1] - display_lim.bmin[1]) /
+                             (data_lim.bmax[index] - data_lim.bmin[index])),
+          display_lim.bmin[1]};
+}
+
+inline AffineMap Aesthetic::color::map(const Limits &data_lim,
+                                       const bfloat2_t &display_lim) {
+  return {data_lim.bmin[index],
+          static_cast<float>(1.0 /
+                             (data_lim.bmax[index] - data_lim.bmin[index])),
+          0.f};
+}
+
+inline AffineMap Aesthetic::size::map(const Limits &data_lim,
+                                      const bfloat2_t &display_lim) {
+  return {data_lim.bmin[index],
+          static_cast<float>(0.05 *
+                             (display_lim.bmax[1] - display_lim.bmin[1]) /
+                             (data_lim.bmax[index] - data_lim.bmin[index])),
+          1.f};
+}
+
+inline AffineMap Aesthetic::fill::map(const Limits &data_lim,
+                                      const bfloat2_t &display_lim) {
+  return {data_lim.bmin[index],
+          static_cast<float>(1.0 /
+                             (data_lim.bmax[index] - data_lim.bmin[index])),
+          0.f};
+}
+
+inline AffineMap Aesthetic::xmin::map(const Limits &data_lim,
+                                      const bfloat2_t &display_lim) {
+  return x::map(data_lim, display_lim);
+}
+
+inline AffineMap Aesthetic::ymin::map(const Limits &data_lim,
+                                      const bfloat2_t &display_lim) {
+  return y::map(data_lim, display_lim);
+}
+
+inline AffineMap Aesthetic::xmax::map(const Limits &data_lim,
+                                      const bfloat2_t &display_lim) {
+  return x::map(data_lim, display_lim);
+}
+
+inline AffineMap Aesthetic::ymax::map(const Limits &data_lim,
+                                      const bfloat2_t &display_lim) {
+  return y::map(data_lim, display_lim);
+}
+
+/// the mapping from each aesthetic (by index) to a RawData column number,
+/// see DataWithAesthetic
+using AestheticMap = std::array<size_t, Aesthetic::N>;
+
 /// Combination of the RawData class and Aesthetics, this class points to a
 /// RawData object, and contains a mapping from aesthetics to RawData column
 /// numbers
+///
+/// The iterators to the column of each aesthetic are cached, and only
+/// refreshed when the RawData is modified (see RawData::version()), so that
+/// begin() and end() are cheap enough to call for every point
 class DataWithAesthetic {
   /// matrix of raw data
   std::shared_ptr<RawData> m_data;
 
-  /// the aethetics define the mapping from x,y,color,.. to column indices
-  std::unordered_map<int, int> m_map;
+  /// the aethetics define the mapping from x,y,color,.. to column indices,
+  /// aesthetics that are not set map to npos
+  AestheticMap m_map;
 
   /// the min/max limits of m_data for each aesthetics
   Limits m_limits;
 
+  /// cached begin/end iterators for each aesthetic
+  mutable std::array<ColumnIterator, Aesthetic::N> m_begin;
+  mutable std::array<ColumnIterator, Aesthetic::N> m_end;
+
+  /// the version of m_data that the cached iterators are valid for
+  mutable size_t m_columns_version;
+
 public:
-  DataWithAesthetic() : m_data(std::make_shared<RawData>()) {}
+  /// the column number of an aesthetic that is not set
+  static const size_t npos = static_cast<size_t>(-1);
+
+  DataWithAesthetic() : DataWithAesthetic(std::make_shared<RawData>()) {}
 
   explicit DataWithAesthetic(std::shared_ptr<RawData> data)
-      : m_data(std::move(data)) {}
+      : m_data(std::move(data)), m_columns_version(npos) {
+    m_map.fill(npos);
+  }
 
-  DataWithAesthetic(std::shared_ptr<RawData> data,
-                    const std::unordered_map<int, int> &map,
+  DataWithAesthetic(std::shared_ptr<RawData> data, const AestheticMap &map,
                     const Limits &limits)
-      : m_data(std::move(data)), m_map(map), m_limits(limits) {}
+      : m_data(std::move(data)), m_map(map), m_limits(limits),
+        m_columns_version(npos) {}
 
   /// return a ColumnIterator to the beginning of the data column for
   /// aesthetic a, throws if a has not yet been set
@@ -276,56 +541,129 @@ public:
   template <typename Aesthetic, typename T>
   void set(const std::vector<T> &data);
 
+  /// as above, but the buffer of `data` is adopted by the data set rather
+  /// than copied
+  template <typename Aesthetic> void set(std::vector<float> &&data);
+
+  /// as above, but the column is stored without copying. This can be used
+  /// to bind an externally owned buffer to aesthetic a, see Column
+  template <typename Aesthetic> void set(Column data);
+
+  /// maps aesthetic a to an existing column of the RawData (e.g. one of the
+  /// columns imported by import_arrow()), without copying it
+  template <typename Aesthetic> void bind(size_t column);
+
   /// rather than adding new data, this allows the limits of a given aesthetic
   /// to be manually set. This is used, for example, with geometries where the
   /// data is implicitly defined over a range (e.g. histograms with regular
   /// bin widths)
-  template <typename Aesthetic> void set(float min, float max);
+  template <typename Aesthetic> void set(double min, double max);
 
   /// returns true if Aesthetic has been set
   template <typename Aesthetic> bool has() const;
 
+  /// returns the min/max of the stored values of the column for Aesthetic,
+  /// see RawData::minmax(). Unlike limits() these are not decoded, or spread
+  /// apart if they are equal
+  template <typename Aesthetic> std::pair<float, float> minmax() const;
+
+  /// returns true if the column for Aesthetic is sorted, see
+  /// RawData::is_sorted()
+  template <typename Aesthetic> bool is_sorted() const;
+
+  /// returns the number of distinct values in the column for Aesthetic, see
+  /// RawData::distinct()
+  template <typename Aesthetic> size_t distinct() const;
+
   /// returns number of rows in the data set
-  int rows() const;
+  size_t rows() const;
 
   /// returns number of cols in the data set
-  int cols() const;
+  size_t cols() const;
 
   /// returns the min/max limits of the data
   const Limits &limits() const;
 
+  /// set the maximum number of rows of the data set, see
+  /// RawData::set_capacity()
+  void set_capacity(size_t capacity);
+
+  /// shares the buffers of any columns that are identical to a column in
+  /// @p pool, see RawData::intern_columns(). The RawData is first copied (the
+  /// copy sharing the column buffers and string dictionaries), so other data
+  /// sets pointing to the same RawData are not modified. Ring buffers (see
+  /// set_capacity()) and data sets with borrowed columns are left as they
+  /// are, as they are updated in place by their owner
+  void intern_columns(ColumnPool &pool);
+
+  /// quantises the data columns to 16 bits to reduce their memory use, see
+  /// RawData::quantise(). As for intern_columns(), other data sets pointing to
+  /// the same RawData are not modified. The limits are recalculated from the
+  /// quantised data
+  void quantise();
+
+  /// add a new row to the data set, the elements of `row` are in the order of
+  /// the data columns. The limits are updated to include the new row (and
+  /// exclude any row dropped from a full data set)
+  template <typename T> void add_row(const std::vector<T> &row);
+
+  /// add a number of new rows to the data set, see add_row() and
+  /// RawData::add_rows()
+  template <typename T> void add_rows(const std::vector<T> &rows);
+
   template <typename T> DataWithAesthetic &x(const std::vector<T> &data);
-  DataWithAesthetic &x(float min, float max);
+  DataWithAesthetic &x(std::vector<float> &&data);
+  DataWithAesthetic &x(Column data);
+  DataWithAesthetic &x(double min, double max);
 
   template <typename T> DataWithAesthetic &y(const std::vector<T> &data);
-  DataWithAesthetic &y(float min, float max);
+  DataWithAesthetic &y(std::vector<float> &&data);
+  DataWithAesthetic &y(Column data);
+  DataWithAesthetic &y(double min, double max);
 
   template <typename T> DataWithAesthetic &color(const std::vector<T> &data);
-  DataWithAesthetic &color(float min, float max);
+  DataWithAesthetic &color(std::vector<float> &&data);
+  DataWithAesthetic &color(Column data);
+  DataWithAesthetic &color(double min, double max);
 
   template <typename T> DataWithAesthetic &size(const std::vector<T> &data);
-  DataWithAesthetic &size(float min, float max);
+  DataWithAesthetic &size(std::vector<float> &&data);
+  DataWithAesthetic &size(Column data);
+  DataWithAesthetic &size(double min, double max);
 
   template <typename T> DataWithAesthetic &fill(const std::vector<T> &data);
-  DataWithAesthetic &fill(float min, float max);
+  DataWithAesthetic &fill(std::vector<float> &&data);
+  DataWithAesthetic &fill(Column data);
+  DataWithAesthetic &fill(double min, double max);
 
   template <typename T> DataWithAesthetic &xmin(const std::vector<T> &data);
-  DataWithAesthetic &xmin(float min, float max);
+  DataWithAesthetic &xmin(std::vector<float> &&data);
+  DataWithAesthetic &xmin(Column data);
+  DataWithAesthetic &xmin(double min, double max);
 
   template <typename T> DataWithAesthetic &ymin(const std::vector<T> &data);
-  DataWithAesthetic &ymin(float min, float max);
+  DataWithAesthetic &ymin(std::vector<float> &&data);
+  DataWithAesthetic &ymin(Column data);
+  DataWithAesthetic &ymin(double min, double max);
 
   template <typename T> DataWithAesthetic &xmax(const std::vector<T> &data);
-  DataWithAesthetic &xmax(float min, float max);
+  DataWithAesthetic &xmax(std::vector<float> &&data);
+  DataWithAesthetic &xmax(Column data);
+  DataWithAesthetic &xmax(double min, double max);
 
   template <typename T> DataWithAesthetic &ymax(const std::vector<T> &data);
-  DataWithAesthetic &ymax(float min, float max);
+  DataWithAesthetic &ymax(std::vector<float> &&data);
+  DataWithAesthetic &ymax(Column data);
+  DataWithAesthetic &ymax(double min, double max);
 
   /// facets the data based on the input data column
   ///
   /// The input data column (of the same number of rows as this dataset)
   /// contains N unique values. This function returns a map of each of these N
   /// values to a dataset containing all the rows that have this value
+  ///
+  /// Each returned dataset is a view (see RawData::facet_view()) that shares
+  /// the columns of this dataset
   template <typename T>
   std::map<T, DataWithAesthetic> facet(const std::vector<T> &data) const;
 
@@ -334,19 +672,123 @@ public:
   /// The input data columns (of the same number of rows as this dataset)
   /// contains NxM unique value pairs. This function returns a map of each of
   /// these NxM values to a dataset containing all the rows that have this value
+  ///
+  /// Each returned dataset is a view (see RawData::facet_view()) that shares
+  /// the columns of this dataset
   template <typename T1, typename T2>
   std::map<std::pair<T1, T2>, DataWithAesthetic>
   facet(const std::vector<T1> &data1, const std::vector<T2> &data2) const;
 
+  /// returns a view of the given @p rows of this dataset, see
+  /// RawData::select(). As for facet(), the view keeps the limits of this
+  /// dataset so that it is drawn on the same scale
+  DataWithAesthetic
+  select(std::shared_ptr<const std::vector<size_t>> rows) const;
+
+  /// returns a view (see select()) of the rows for which @p predicate is true.
+  /// The predicate is called with the decoded values of the given Aesthetics
+  /// for each row, e.g.
+  ///
+  /// \code
+  /// auto subset = data.filter<Aesthetic::x, Aesthetic::color>(
+  ///     [](double x, double color) { return x > 0 && color == 2; });
+  /// \endcode
+  ///
+  /// the rows are not copied, so this is cheap enough to toggle subsets of a
+  /// large dataset interactively
+  template <typename... Aesthetics, typename Predicate>
+  DataWithAesthetic filter(Predicate predicate) const;
+
 private:
-  template <typename Aesthetic, typename T>
-  void calculate_limits(T begin, T end);
+  friend class DataBuilder;
+
+  template <typename Aesthetic> void calculate_limits(size_t column);
+
+  /// calculates the limits of all the aesthetics that have been set
+  void calculate_limits();
+
+  /// refreshes the cached column iterators if m_data has been modified
+  void update_columns() const {
+    if (m_columns_version != m_data->version()) {
+      cache_columns();
+    }
+  }
+
+  /// caches the column iterators of each aesthetic
+  void cache_columns() const;
 };
 
 /// creates a new, empty dataset
 /// \return an empty DataWithAesthetic
 DataWithAesthetic create_data();
 
+/// Builds a DataWithAesthetic from all of its aesthetic columns at once
+///
+/// The chained setters of DataWithAesthetic (e.g. create_data().x(a).y(b))
+/// add the columns one at a time, checking the number of rows and calculating
+/// the limits at each step. A DataBuilder instead collects the columns, and
+/// build() then checks that they all have the same number of rows before
+/// adding any of them, allocates the columns of the RawData once, and
+/// calculates the limits of all the aesthetics together
+///
+/// \code
+/// auto data = DataBuilder().x(x).y(y).size(size).color(color).build();
+/// \endcode
+class DataBuilder {
+  /// the column (and dictionary of strings, see RawData::string_data()) of
+  /// each aesthetic
+  std::array<Column, Aesthetic::N> m_columns;
+  std::array<std::vector<std::string>, Aesthetic::N> m_string_data;
+
+  /// true for each aesthetic that has been set
+  std::array<bool, Aesthetic::N> m_set{};
+
+public:
+  /// sets the data of aesthetic a, which is copied (see
+  /// DataWithAesthetic::set())
+  template <typename Aesthetic, typename T>
+  DataBuilder &set(const std::vector<T> &data);
+
+  /// as above, but the buffer of `data` is adopted rather than copied
+  template <typename Aesthetic> DataBuilder &set(std::vector<float> &&data);
+
+  /// as above, but the column is stored without copying
+  template <typename Aesthetic> DataBuilder &set(Column data);
+
+  template <typename T> DataBuilder &x(T &&data) {
+    return set<Aesthetic::x>(std::forward<T>(data));
+  }
+  template <typename T> DataBuilder &y(T &&data) {
+    return set<Aesthetic::y>(std::forward<T>(data));
+  }
+  template <typename T> DataBuilder &color(T &&data) {
+    return set<Aesthetic::color>(std::forward<T>(data));
+  }
+  template <typename T> DataBuilder &size(T &&data) {
+    return set<Aesthetic::size>(std::forward<T>(data));
+  }
+  template <typename T> DataBuilder &fill(T &&data) {
+    return set<Aesthetic::fill>(std::forward<T>(data));
+  }
+  template <typename T> DataBuilder &xmin(T &&data) {
+    return set<Aesthetic::xmin>(std::forward<T>(data));
+  }
+  template <typename T> DataBuilder &ymin(T &&data) {
+    return set<Aesthetic::ymin>(std::forward<T>(data));
+  }
+  template <typename T> DataBuilder &xmax(T &&data) {
+    return set<Aesthetic::xmax>(std::forward<T>(data));
+  }
+  template <typename T> DataBuilder &ymax(T &&data) {
+    return set<Aesthetic::ymax>(std::forward<T>(data));
+  }
+
+  /// creates the data set from the columns that have been set, and resets the
+  /// builder. Throws trase::Exception if the columns do not all have the same
+  /// number of rows
+  DataWithAesthetic build();
+};
+
 } // namespace trase
 
 #include "Data.tcc"
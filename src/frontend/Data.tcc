@@ -35,40 +35,31 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace trase {
 
-// helper function to cast type T to a float
+// helper function to convert a column of data given by the two iterators
+// new_col_begin and new_col_end to floats
 //
-// by default, will use static_cast to cast T to float
-// if T is a std::string, then:
-//   if string_data is not empty: returns a float equal to the index of arg in
-//   the set if string_data is empty: returns stof(arg)
+// by default, will use static_cast to cast each element to a float
+// if the value_type of the data is a std::string, then:
+//   if the first element can be converted to a float by stof: all the elements
+//   are converted using stof
+//   otherwise: the column is dictionary encoded. The unique strings are stored
+//   in sorted order in string_data, and each element is converted to the
+//   index of its string in string_data
 template <typename T>
-float cast_to_float(const T &arg, const std::set<std::string> &string_data) {
-  return static_cast<float>(arg);
-}
-
-template <>
-float cast_to_float<std::string>(const std::string &arg,
-                                 const std::set<std::string> &string_data);
-
-// helper function to parse a column of data given by the two iterators
-// new_col_begin and new_col_end
-//
-// if the value_type of the data is a std::string, and the first element cannot
-// be converted to a float by stof, then the strings in the data column are
-// copied to the set string_data
-template <typename T>
-void store_non_numeric_strings(T new_col_begin, T new_col_end,
-                               std::set<std::string> &string_data);
+std::vector<float> encode_column(T new_col_begin, T new_col_end,
+                                 std::vector<std::string> &string_data);
 
 // the function above uses tag dispatching based on the value_type of the data
 // column. This function is chosen if the value_type is a std::string
 template <typename T>
-void store_non_numeric_strings(T new_col_begin, T new_col_end,
-                               std::set<std::string> &string_data,
-                               std::true_type) {
-
-  if (new_col_begin == new_col_end)
-    return;
+std::vector<float> encode_column(T new_col_begin, T new_col_end,
+                                 std::vector<std::string> &string_data,
+                                 std::true_type) {
+  string_data.clear();
+  std::vector<float> values(std::distance(new_col_begin, new_col_end));
+  if (new_col_begin == new_col_end) {
+    return values;
+  }
 
   size_t pos;
   bool failed = false;
@@ -78,27 +69,68 @@ void store_non_numeric_strings(T new_col_begin, T new_col_end,
     failed = true;
   }
 
-  // if exception caught or if not all characters convered, then the first
-  // element is a non-numeric string.  if the first element is a non-numeric
-  // string, assume the rest are and process them into string_data
-  if (failed || pos < new_col_begin->size()) {
-    std::copy(new_col_begin, new_col_end,
-              std::inserter(string_data, string_data.begin()));
+  // if no exception caught and all characters converted, then the first
+  // element is a numeric string. assume the rest are too
+  if (!failed && pos == new_col_begin->size()) {
+    std::transform(new_col_begin, new_col_end, values.begin(),
+                   [](const std::string &i) { return std::stof(i); });
+    return values;
+  }
+
+  // otherwise assume the rest are non-numeric strings. Give each unique string
+  // a code in order of first appearance, using a single hashing pass
+  std::unordered_map<std::string, size_t> codes;
+  std::vector<size_t> row_codes(values.size());
+  auto row_code = row_codes.begin();
+  for (auto i = new_col_begin; i != new_col_end; ++i) {
+    *row_code++ = codes.emplace(*i, codes.size()).first->second;
   }
+
+  // codes are stored as floats, which are exact up to 2^24
+  if (codes.size() > (size_t(1) << 24)) {
+    throw Exception("too many unique strings to encode column");
+  }
+
+  // renumber the codes to follow the sorted order of the strings
+  std::vector<const std::string *> strings(codes.size());
+  for (const auto &code : codes) {
+    strings[code.second] = &code.first;
+  }
+  std::vector<size_t> order(codes.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return *strings[a] < *strings[b];
+  });
+  std::vector<float> sorted_codes(codes.size());
+  string_data.reserve(codes.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    sorted_codes[order[i]] = static_cast<float>(i);
+    string_data.push_back(*strings[order[i]]);
+  }
+  std::transform(row_codes.begin(), row_codes.end(), values.begin(),
+                 [&](size_t i) { return sorted_codes[i]; });
+  return values;
 }
 
 // the function above uses tag dispatching based on the value_type of the data
 // column. This function is chosen if the value_type is not a std::string
 template <typename T>
-void store_non_numeric_strings(T new_col_begin, T new_col_end,
-                               std::set<std::string> &string_data,
-                               std::false_type) {}
+std::vector<float> encode_column(T new_col_begin, T new_col_end,
+                                 std::vector<std::string> &string_data,
+                                 std::false_type) {
+  string_data.clear();
+  // (not using std::copy because visual studio complains if T is not float)
+  std::vector<float> values(std::distance(new_col_begin, new_col_end));
+  std::transform(new_col_begin, new_col_end, values.begin(),
+                 [](const auto &i) { return static_cast<float>(i); });
+  return values;
+}
 
 // see declaration above
 template <typename T>
-void store_non_numeric_strings(T new_col_begin, T new_col_end,
-                               std::set<std::string> &string_data) {
-  store_non_numeric_strings(
+std::vector<float> encode_column(T new_col_begin, T new_col_end,
+                                 std::vector<std::string> &string_data) {
+  return encode_column(
       new_col_begin, new_col_end, string_data,
       std::is_same<typename std::iterator_traits<T>::value_type,
                    std::string>());
@@ -108,58 +140,44 @@ template <typename T> void RawData::add_column(T new_col_begin, T new_col_end) {
   const size_t n = std::distance(new_col_begin, new_col_end);
 
   // check number of rows in new column match
-  if (m_cols > 0 && static_cast<int>(n) != m_rows) {
+  if (m_cols > 0 && n != m_rows) {
     throw Exception("columns in dataset must have identical number of rows");
   }
 
-  m_string_data.emplace_back();
-  store_non_numeric_strings(new_col_begin, new_col_end, m_string_data.back());
-
-  // if columns already exist then add the extra memory
-  if (m_cols > 0) {
-
-    // resize tmp vector
-    m_tmp.resize(m_rows * (m_cols + 1));
-
-    // copy orig data and new column to m_tmp
-    for (int i = 0; i < m_rows; ++i) {
-      for (int j = 0; j < m_cols; ++j) {
-        m_tmp[i * (m_cols + 1) + j] = m_matrix[i * m_cols + j];
-      }
-      m_tmp[i * (m_cols + 1) + m_cols] =
-          cast_to_float(*new_col_begin++, m_string_data.back());
-    }
-
-    // swap data back to m_matrix
-    m_matrix.swap(m_tmp);
-  } else {
-    // first column for matrix, set num rows and cols to match it
-    m_rows = static_cast<int>(n);
-    m_matrix.resize(m_rows);
-
-    // copy data in (not using std::copy because visual studio complains if T
-    // is not float)
-    std::transform(
-        new_col_begin, new_col_end, m_matrix.begin(),
-        [this](auto i) { return cast_to_float(i, m_string_data.back()); });
-  }
-  ++m_cols;
+  // copy data into a new column buffer, the existing columns are untouched
+  std::vector<std::string> string_data;
+  add_column(
+      Column(encode_column(new_col_begin, new_col_end, string_data)));
+  m_string_data.back() = share_dictionary(std::move(string_data));
 }
 
 template <typename T> void RawData::add_row(T new_row_begin, T new_row_end) {
   const size_t n = std::distance(new_row_begin, new_row_end);
   // check number of cols in new row match
-  if (m_rows > 0 && static_cast<int>(n) != m_cols) {
+  if (m_rows > 0 && n != m_cols) {
     throw Exception("rows in dataset must have identical number of columns");
   }
-  m_cols = static_cast<int>(n);
-  ++m_rows;
-  const size_t oldn = m_matrix.size();
-  m_matrix.resize(oldn + n);
-  // copy data in (not using std::copy because visual studio complains if T
-  // is not float)
-  std::transform(new_row_begin, new_row_end, m_matrix.begin() + oldn,
-                 [this](auto i) { return static_cast<float>(i); });
+
+  // first row for matrix sets num cols to match it
+  if (m_rows == 0) {
+    m_cols = n;
+    m_columns.resize(n);
+    m_string_data.resize(n);
+    if (m_capacity) {
+      for (auto &column : m_columns) {
+        column.set_capacity(m_capacity);
+      }
+    }
+  }
+  if (m_capacity == 0 || m_rows < m_capacity) {
+    ++m_rows;
+  }
+  ++m_version;
+
+  // append each element to the end of its column
+  for (auto &column : m_columns) {
+    column.push_back(static_cast<double>(*new_row_begin++));
+  }
 }
 
 template <typename T> void RawData::add_column(const std::vector<T> &new_col) {
@@ -170,63 +188,143 @@ template <typename T> void RawData::add_row(const std::vector<T> &new_row) {
   add_row(new_row.begin(), new_row.end());
 }
 
+template <typename T> void RawData::add_rows(const std::vector<T> &new_rows) {
+  if (new_rows.empty()) {
+    return;
+  }
+  // check number of cols in new rows match
+  if (m_cols == 0 || new_rows.size() % m_cols != 0) {
+    throw Exception("rows in dataset must have identical number of columns");
+  }
+
+  // append column by column, so each column buffer is traversed once
+  for (size_t k = 0; k < m_cols; ++k) {
+    for (size_t i = k; i < new_rows.size(); i += m_cols) {
+      m_columns[k].push_back(static_cast<double>(new_rows[i]));
+    }
+  }
+  m_rows += new_rows.size() / m_cols;
+  if (m_capacity && m_rows > m_capacity) {
+    m_rows = m_capacity;
+  }
+  ++m_version;
+}
+
 template <typename T>
-void RawData::set_column(const int i, const std::vector<T> &new_col) {
+void RawData::set_column(const size_t i, const std::vector<T> &new_col) {
 
   // check column exists
-  if (i < 0 || i >= cols()) {
+  if (i >= cols()) {
     throw std::out_of_range("column index out of range");
   }
 
   // check number of rows in new column match
-  if (static_cast<int>(new_col.size()) != m_rows) {
+  if (new_col.size() != m_rows) {
     throw Exception("columns in dataset must have identical number of rows");
   }
 
-  m_string_data[i].clear();
-  store_non_numeric_strings(new_col.begin(), new_col.end(), m_string_data[i]);
-
   // copy column
-  for (int j = 0; j < m_rows; ++j) {
-    m_matrix[j * m_cols + i] = cast_to_float(new_col[j], m_string_data[i]);
+  std::vector<std::string> string_data;
+  set_column(i, Column(encode_column(new_col.begin(), new_col.end(),
+                                     string_data)));
+  m_string_data[i] = share_dictionary(std::move(string_data));
+}
+
+// hash function used to group the rows of a dataset by their facet key
+template <typename T> struct FacetHash {
+  size_t operator()(const T &arg) const { return std::hash<T>()(arg); }
+};
+
+template <typename T1, typename T2> struct FacetHash<std::pair<T1, T2>> {
+  size_t operator()(const std::pair<T1, T2> &arg) const {
+    const size_t h1 = FacetHash<T1>()(arg.first);
+    const size_t h2 = FacetHash<T2>()(arg.second);
+    return h1 ^ (h2 + 0x9e3779b9 + (h1 << 6) + (h1 >> 2));
+  }
+};
+
+template <typename Key, typename KeyFunction>
+std::map<Key, std::shared_ptr<RawData>>
+RawData::facet_by(KeyFunction key, const bool view) const {
+  // assign each row to a group, numbering groups in order of first appearance
+  std::unordered_map<Key, size_t, FacetHash<Key>> group_index;
+  std::vector<Key> group_keys;
+  std::vector<size_t> group_rows;
+  std::vector<size_t> row_group(m_rows);
+  for (size_t i = 0; i < m_rows; ++i) {
+    auto inserted = group_index.emplace(key(i), group_keys.size());
+    if (inserted.second) {
+      group_keys.push_back(inserted.first->first);
+      group_rows.push_back(0);
+    }
+    row_group[i] = inserted.first->second;
+    ++group_rows[row_group[i]];
+  }
+
+  const size_t n = group_keys.size();
+  std::vector<std::shared_ptr<RawData>> facets(n);
+  for (auto &facet : facets) {
+    facet = std::make_shared<RawData>();
+    facet->reserve(m_cols);
   }
+
+  if (view) {
+    // scatter the row indices into one selection per group, each facet then
+    // shares the columns of this dataset
+    std::vector<std::shared_ptr<std::vector<size_t>>> selections(n);
+    std::vector<size_t *> out(n);
+    for (size_t g = 0; g < n; ++g) {
+      selections[g] = std::make_shared<std::vector<size_t>>(group_rows[g]);
+      out[g] = selections[g]->data();
+    }
+    for (size_t i = 0; i < m_rows; ++i) {
+      *out[row_group[i]]++ = i;
+    }
+    for (size_t g = 0; g < n; ++g) {
+      for (size_t k = 0; k < m_cols; ++k) {
+        facets[g]->add_column(m_columns[k].select(selections[g]));
+        facets[g]->m_string_data.back() = m_string_data[k];
+      }
+    }
+  } else {
+    // scatter each column into one buffer per group, preserving the row
+    // order within each group
+    for (size_t k = 0; k < m_cols; ++k) {
+      std::vector<std::vector<float>> buffers(n);
+      std::vector<float *> out(n);
+      for (size_t g = 0; g < n; ++g) {
+        buffers[g].resize(group_rows[g]);
+        out[g] = buffers[g].data();
+      }
+      auto column = begin(k);
+      for (size_t i = 0; i < m_rows; ++i) {
+        *out[row_group[i]]++ = column[static_cast<std::ptrdiff_t>(i)];
+      }
+      for (size_t g = 0; g < n; ++g) {
+        facets[g]->add_column(Column(std::move(buffers[g]), column.offset()));
+        facets[g]->m_string_data.back() = m_string_data[k];
+      }
+    }
+  }
+
+  std::map<Key, std::shared_ptr<RawData>> fdata;
+  for (size_t g = 0; g < n; ++g) {
+    fdata.emplace(std::move(group_keys[g]), std::move(facets[g]));
+  }
+  return fdata;
 }
 
 template <typename T>
 std::map<T, std::shared_ptr<RawData>>
 RawData::facet(const std::vector<T> &data) const {
   // check number of rows in new column match
-  if (m_cols > 0 && static_cast<int>(data.size()) != m_rows) {
+  if (m_cols > 0 && data.size() != m_rows) {
     throw Exception(
         "facet column must have an identical number of rows to the dataset");
   }
 
-  std::map<T, std::shared_ptr<RawData>> fdata;
-
-  std::vector<std::size_t> row_indices(rows());
-  std::iota(row_indices.begin(), row_indices.end(), 0);
-  std::stable_sort(
-      row_indices.begin(), row_indices.end(),
-      [&](std::size_t i, std::size_t j) { return data[i] < data[j]; });
-
-  auto i = row_indices.begin();
-  for (auto j = i; i != row_indices.end(); i = j) {
-    while (j != row_indices.end() && data[*j] <= data[*i]) {
-      ++j;
-    }
-
-    const auto ji_diff = static_cast<size_t>(j - i);
-    std::vector<float> tmp(ji_diff);
-    auto &facet = fdata[data[*i]];
-    facet = std::make_shared<RawData>();
-    for (int k = 0; k < cols(); ++k) {
-      std::transform(i, j, tmp.begin(), [row = begin(k)](size_t i) {
-        return row[static_cast<int>(i)];
-      });
-      facet->add_column(tmp);
-    }
-  }
-  return fdata;
+  return facet_by<T>([&](const size_t i) -> const T & { return data[i]; },
+                     false);
 }
 
 template <typename T1, typename T2>
@@ -234,32 +332,52 @@ std::map<std::pair<T1, T2>, std::shared_ptr<RawData>>
 RawData::facet(const std::vector<T1> &data1,
                const std::vector<T2> &data2) const {
   // check number of rows in new column match
-  if (m_cols > 0 && static_cast<int>(data1.size()) != m_rows) {
+  if (m_cols > 0 && data1.size() != m_rows) {
     throw Exception(
         "facet column 1 must have an identical number of rows to the dataset");
   }
   // check number of rows in new column match
-  if (m_cols > 0 && static_cast<int>(data2.size()) != m_rows) {
+  if (m_cols > 0 && data2.size() != m_rows) {
     throw Exception(
         "facet column 2 must have an identical number of rows to the dataset");
   }
 
-  std::map<std::pair<T1, T2>, std::shared_ptr<RawData>> fdata;
+  return facet_by<std::pair<T1, T2>>(
+      [&](const size_t i) { return std::make_pair(data1[i], data2[i]); },
+      false);
+}
 
-  // insert all rows into map, with key given by pair(data1,data2)
-  for (size_t i = 0; i < data1.size(); ++i) {
-    auto &facet = fdata[std::make_pair(data1[i], data2[i])];
-    if (!facet) {
-      facet = std::make_shared<RawData>();
-    }
-    std::vector<float> row(cols());
-    for (int k = 0; k < cols(); ++k) {
-      row[k] = begin(k)[static_cast<int>(i)];
-    }
-    facet->add_row(row);
+template <typename T>
+std::map<T, std::shared_ptr<RawData>>
+RawData::facet_view(const std::vector<T> &data) const {
+  // check number of rows in new column match
+  if (m_cols > 0 && data.size() != m_rows) {
+    throw Exception(
+        "facet column must have an identical number of rows to the dataset");
   }
 
-  return fdata;
+  return facet_by<T>([&](const size_t i) -> const T & { return data[i]; },
+                     true);
+}
+
+template <typename T1, typename T2>
+std::map<std::pair<T1, T2>, std::shared_ptr<RawData>>
+RawData::facet_view(const std::vector<T1> &data1,
+                    const std::vector<T2> &data2) const {
+  // check number of rows in new column match
+  if (m_cols > 0 && data1.size() != m_rows) {
+    throw Exception(
+        "facet column 1 must have an identical number of rows to the dataset");
+  }
+  // check number of rows in new column match
+  if (m_cols > 0 && data2.size() != m_rows) {
+    throw Exception(
+        "facet column 2 must have an identical number of rows to the dataset");
+  }
+
+  return facet_by<std::pair<T1, T2>>(
+      [&](const size_t i) { return std::make_pair(data1[i], data2[i]); },
+      true);
 }
 
 template <typename T>
@@ -267,7 +385,7 @@ std::map<T, DataWithAesthetic>
 DataWithAesthetic::facet(const std::vector<T> &data) const {
   std::map<T, DataWithAesthetic> faceted_data;
 
-  for (auto raw_data : m_data->facet(data)) {
+  for (auto raw_data : m_data->facet_view(data)) {
     faceted_data[raw_data.first] =
         DataWithAesthetic(raw_data.second, m_map, m_limits);
   }
@@ -281,7 +399,7 @@ DataWithAesthetic::facet(const std::vector<T1> &data1,
                          const std::vector<T2> &data2) const {
   std::map<std::pair<T1, T2>, DataWithAesthetic> faceted_data;
 
-  for (auto raw_data : m_data->facet(data1, data2)) {
+  for (auto raw_data : m_data->facet_view(data1, data2)) {
     faceted_data[raw_data.first] =
         DataWithAesthetic(raw_data.second, m_map, m_limits);
   }
@@ -289,46 +407,175 @@ DataWithAesthetic::facet(const std::vector<T1> &data1,
   return faceted_data;
 }
 
-template <typename Aesthetic, typename T>
-void DataWithAesthetic::calculate_limits(T begin, T end) {
-  if (begin != end) {
-    // set m_limits with new data
-    auto min_max = std::minmax_element(begin, end);
-    float min = *min_max.first;
-    float max = *min_max.second;
-
-    // if limits are equal spread them out by 2*1e4*eps to stop zeros later on
-    if (min == max) {
-      min -= 1e4f * std::numeric_limits<float>::epsilon();
-      max += 1e4f * std::numeric_limits<float>::epsilon();
+template <typename Predicate>
+std::shared_ptr<RawData> RawData::filter(Predicate predicate) const {
+  auto rows = std::make_shared<std::vector<size_t>>();
+  for (size_t i = 0; i < m_rows; ++i) {
+    if (predicate(i)) {
+      rows->push_back(i);
     }
-
-    set<Aesthetic>(min, max);
   }
+  return select(std::move(rows));
+}
+
+// calls predicate with the decoded values of row i of each column
+template <typename Predicate, typename Columns, size_t... I>
+bool apply_predicate(Predicate &predicate, const Columns &columns,
+                     const size_t i, std::index_sequence<I...>) {
+  return predicate(columns[I].decode(static_cast<std::ptrdiff_t>(i))...);
+}
+
+template <typename... Aesthetics, typename Predicate>
+DataWithAesthetic DataWithAesthetic::filter(Predicate predicate) const {
+  const std::array<ColumnIterator, sizeof...(Aesthetics)> columns = {
+      {begin<Aesthetics>()...}};
+  auto row_predicate = [&](const size_t i) {
+    return apply_predicate(predicate, columns, i,
+                           std::index_sequence_for<Aesthetics...>());
+  };
+  return DataWithAesthetic(m_data->filter(row_predicate), m_map, m_limits);
 }
 
 template <typename Aesthetic, typename T>
 void DataWithAesthetic::set(const std::vector<T> &data) {
 
-  auto search = m_map.find(Aesthetic::index);
+  auto &column = m_map[Aesthetic::index];
 
-  if (search == m_map.end()) {
+  if (column == npos) {
     // if aesthetic is not in data then add a new column
-    search = m_map.insert({Aesthetic::index, m_data->cols()}).first;
     m_data->add_column(data);
+    column = m_data->cols() - 1;
   } else {
     // copy data to column (TODO: move this into RawData class)
-    m_data->set_column(search->second, data);
+    m_data->set_column(column, data);
+  }
+
+  calculate_limits<Aesthetic>(column);
+}
+
+template <typename Aesthetic>
+void DataWithAesthetic::set(std::vector<float> &&data) {
+  set<Aesthetic>(Column(std::move(data)));
+}
+
+template <typename Aesthetic> void DataWithAesthetic::set(Column data) {
+
+  auto &column = m_map[Aesthetic::index];
+
+  if (column == npos) {
+    // if aesthetic is not in data then add a new column
+    m_data->add_column(std::move(data));
+    column = m_data->cols() - 1;
+  } else {
+    m_data->set_column(column, std::move(data));
   }
 
-  calculate_limits<Aesthetic>(m_data->begin(search->second),
-                              m_data->end(search->second));
+  calculate_limits<Aesthetic>(column);
+}
+
+template <typename Aesthetic>
+void DataWithAesthetic::bind(const size_t column) {
+  if (column >= m_data->cols()) {
+    throw std::out_of_range("column index out of range");
+  }
+  m_map[Aesthetic::index] = column;
+  m_columns_version = npos;
+  calculate_limits<Aesthetic>(column);
+}
+
+template <typename Aesthetic, typename T>
+DataBuilder &DataBuilder::set(const std::vector<T> &data) {
+  auto &string_data = m_string_data[Aesthetic::index];
+  return set<Aesthetic>(
+      Column(encode_column(data.begin(), data.end(), string_data)));
+}
+
+template <typename Aesthetic>
+DataBuilder &DataBuilder::set(std::vector<float> &&data) {
+  m_string_data[Aesthetic::index].clear();
+  return set<Aesthetic>(Column(std::move(data)));
+}
+
+template <typename Aesthetic> DataBuilder &DataBuilder::set(Column data) {
+  m_columns[Aesthetic::index] = std::move(data);
+  m_set[Aesthetic::index] = true;
+  return *this;
+}
+
+template <typename Aesthetic>
+void DataWithAesthetic::calculate_limits(const size_t column) {
+  if (m_data->rows() > 0) {
+    // set m_limits with new data
+    const auto min_max = m_data->decoded_minmax(column);
+    double min = min_max.first;
+    double max = min_max.second;
+
+    // if limits are equal spread them out by 1e4 float eps relative to their
+    // magnitude (so that large offsets still spread) to stop zeros later on
+    if (min == max) {
+      const double spread = 1e4 * std::numeric_limits<float>::epsilon() *
+                            std::max(1.0, std::abs(min));
+      min -= spread;
+      max += spread;
+    }
+
+    set<Aesthetic>(min, max);
+  }
+}
+
+template <typename T>
+void DataWithAesthetic::add_row(const std::vector<T> &row) {
+  m_data->add_row(row);
+  calculate_limits();
+}
+
+template <typename T>
+void DataWithAesthetic::add_rows(const std::vector<T> &rows) {
+  m_data->add_rows(rows);
+  calculate_limits();
 }
 
 /// returns true if Aesthetic has been set
 template <typename Aesthetic> bool DataWithAesthetic::has() const {
-  auto search = m_map.find(Aesthetic::index);
-  return search != m_map.end();
+  return m_map[Aesthetic::index] != npos;
+}
+
+template <typename Aesthetic>
+std::pair<float, float> DataWithAesthetic::minmax() const {
+  if (m_map[Aesthetic::index] == npos) {
+    throw Exception(Aesthetic::name + std::string(" aestheic not provided"));
+  }
+  return m_data->minmax(m_map[Aesthetic::index]);
+}
+
+template <typename Aesthetic> bool DataWithAesthetic::is_sorted() const {
+  if (m_map[Aesthetic::index] == npos) {
+    throw Exception(Aesthetic::name + std::string(" aestheic not provided"));
+  }
+  return m_data->is_sorted(m_map[Aesthetic::index]);
+}
+
+template <typename Aesthetic> size_t DataWithAesthetic::distinct() const {
+  if (m_map[Aesthetic::index] == npos) {
+    throw Exception(Aesthetic::name + std::string(" aestheic not provided"));
+  }
+  return m_data->distinct(m_map[Aesthetic::index]);
+}
+
+template <typename Aesthetic> ColumnIterator DataWithAesthetic::begin() const {
+  if (m_map[Aesthetic::index] == npos) {
+    throw Exception(Aesthetic::name + std::string(" aestheic not provided"));
+  }
+  update_columns();
+  return m_begin[Aesthetic::index];
+}
+
+template <typename Aesthetic> ColumnIterator DataWithAesthetic::end() const {
+  if (m_map[Aesthetic::index] == npos) {
+    throw Exception(Aesthetic::name + std::string(" aestheic not provided"));
+  }
+  update_columns();
+  return m_end[Aesthetic::index];
 }
 
 template <typename T>
@@ -386,7 +633,7 @@ DataWithAesthetic &DataWithAesthetic::ymax(const std::vector<T> &data) {
 }
 
 template <typename Aesthetic>
-void DataWithAesthetic::set(const float min, const float max) {
+void DataWithAesthetic::set(const double min, const double max) {
   m_limits.bmin[Aesthetic::index] = min;
   m_limits.bmax[Aesthetic::index] = max;
 }
@@ -394,15 +641,19 @@ void DataWithAesthetic::set(const float min, const float max) {
 // specialisations of set here for xmin,xmax,ymin,ymax (these set the x/y
 // aesthetic bounds accordingly)
 template <>
-void DataWithAesthetic::set<Aesthetic::xmin>(const float min, const float max);
+void DataWithAesthetic::set<Aesthetic::xmin>(const double min,
+                                             const double max);
 
 template <>
-void DataWithAesthetic::set<Aesthetic::xmax>(const float min, const float max);
+void DataWithAesthetic::set<Aesthetic::xmax>(const double min,
+                                             const double max);
 
 template <>
-void DataWithAesthetic::set<Aesthetic::ymin>(const float min, const float max);
+void DataWithAesthetic::set<Aesthetic::ymin>(const double min,
+                                             const double max);
 
 template <>
-void DataWithAesthetic::set<Aesthetic::ymax>(const float min, const float max);
+void DataWithAesthetic::set<Aesthetic::ymax>(const double min,
+                                             const double max);
 
 } // namespace trase
@@ -45,8 +45,19 @@ Geometry::Geometry(Axis *parent)
       m_colormap(&Colormaps::viridis), m_axis(parent) {}
 
 void Geometry::add_frame(const DataWithAesthetic &data, float time) {
-  // add new data frame
+  // add new data frame, sharing the buffers of any columns that are identical
+  // to those in previous frames. A single frame is left as it is, so that the
+  // data set it points to can still be updated in place (e.g. by add_row())
   m_data.push_back(m_transform(data));
+  if (m_quantised_frames) {
+    m_data.back().quantise();
+  }
+  if (m_data.size() == 2) {
+    m_data.front().intern_columns(m_columns);
+  }
+  if (m_data.size() > 1) {
+    m_data.back().intern_columns(m_columns);
+  }
 
   // add new frame time
   if (time > 0) {
@@ -62,4 +73,16 @@ void Geometry::add_frame(const DataWithAesthetic &data, float time) {
       m_limits * Limits::vector_t::Constant(buffer);
 }
 
+void Geometry::set_quantised_frames(const bool quantised) {
+  if (quantised && !m_quantised_frames) {
+    // rebuild the pool so that it no longer holds the unquantised columns
+    m_columns = ColumnPool();
+    for (auto &data : m_data) {
+      data.quantise();
+      data.intern_columns(m_columns);
+    }
+  }
+  m_quantised_frames = quantised;
+}
+
 } // namespace trase
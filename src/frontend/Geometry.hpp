@@ -44,6 +44,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "frontend/Transform.hpp"
 #include "util/BBox.hpp"
 #include "util/Colors.hpp"
+#include "util/ColumnPool.hpp"
 #include "util/Exception.hpp"
 
 namespace trase {
@@ -62,12 +63,19 @@ protected:
   /// colormap
   const Colormap *m_colormap;
 
+  /// the distinct data columns of all frames, used to share identical
+  /// columns between frames
+  ColumnPool m_columns;
+
   /// min/max limits of m_data across all frames
   Limits m_limits;
 
   /// transform
   Transform m_transform;
 
+  /// true if new data frames are quantised, see set_quantised_frames()
+  bool m_quantised_frames{false};
+
   /// parent axis
   Axis *m_axis;
 
@@ -77,7 +85,10 @@ public:
   /// Adds a new data frame to this plot
   ///
   /// The limits of the new data frame will be added to the limits of this
-  /// plot, and the parent axis
+  /// plot, and the parent axis. These limits are not refreshed afterwards:
+  /// rows added later to a data set that a frame points to (e.g. a ring
+  /// buffer of live data, see RawData::set_capacity()) are drawn, but the
+  /// plot and axis keep the limits the frame had when it was added
   ///
   /// \param data the new data frame
   /// \param time the timestamp for this frame. This must be greater than the
@@ -98,6 +109,15 @@ public:
   /// before the data is stored internally
   void set_transform(const Transform &transform) { m_transform = transform; }
 
+  /// Sets whether data frames are stored in a compact quantised form
+  ///
+  /// \param quantised if true, the existing data frames and all new data
+  /// frames added to the plot are quantised to 16 bits (see
+  /// DataWithAesthetic::quantise()) after the transform is applied. This
+  /// halves the memory used by long animations, and keeps the error of each
+  /// point well below a pixel
+  void set_quantised_frames(bool quantised);
+
   /// Set the label
   ///
   /// This label describes the plot and is shown on the axis legend
@@ -74,13 +74,21 @@ void Histogram::draw_frames(AnimatedBackend &backend) {
   const float dx =
       (m_data[0].limits().bmax[Aesthetic::x::index] - x0) / m_data[0].rows();
 
-  for (int i = 0; i < m_data[0].rows(); ++i) {
+  const auto to_x = m_axis->map<Aesthetic::x>();
+  const auto to_y = m_axis->map<Aesthetic::y>();
+  const auto y_max = to_y(0.0);
+
+  // get the column iterators of every frame once, outside the loop over bins
+  std::vector<ColumnIterator> y;
+  for (const auto &data : m_data) {
+    y.push_back(data.begin<Aesthetic::y>());
+  }
+
+  for (size_t i = 0; i < m_data[0].rows(); ++i) {
+    const auto x_min = to_x(i * dx + x0);
+    const auto x_max = to_x((i + 1.f) * dx + x0);
     for (size_t f = 0; f < m_times.size(); ++f) {
-      auto y_data = m_data[f].begin<Aesthetic::y>()[i];
-      auto y_min = m_axis->to_display<Aesthetic::y>(y_data);
-      auto y_max = m_axis->to_display<Aesthetic::y>(0.f);
-      auto x_min = m_axis->to_display<Aesthetic::x>(i * dx + x0);
-      auto x_max = m_axis->to_display<Aesthetic::x>((i + 1.f) * dx + x0);
+      auto y_min = to_y(y[f].decode(i));
       backend.add_animated_rect(bfloat2_t({x_min, y_min}, {x_max, y_max}),
                                 m_times[f]);
     }
@@ -104,27 +112,26 @@ template <typename Backend> void Histogram::draw_plot(Backend &backend) {
   const float dx =
       (m_data[0].limits().bmax[Aesthetic::x::index] - x0) / m_data[0].rows();
 
-  if (w2 == 0.0f) {
-    // exactly on a single frame
-    auto y_data = m_data[f].begin<Aesthetic::y>();
-    for (int i = 0; i < m_data[0].rows(); ++i) {
-      auto x_min = m_axis->to_display<Aesthetic::x>(i * dx + x0);
-      auto x_max = m_axis->to_display<Aesthetic::x>((i + 1.f) * dx + x0);
-      auto y_min = m_axis->to_display<Aesthetic::y>(y_data[i]);
-      auto y_max = m_axis->to_display<Aesthetic::y>(0.f);
-      backend.rect(bfloat2_t({x_min, y_min}, {x_max, y_max}));
-    }
-  } else {
-    auto y0 = m_data[f - 1].begin<Aesthetic::y>();
-    auto y1 = m_data[f].begin<Aesthetic::y>();
-    for (int i = 0; i < m_data[0].rows(); ++i) {
-      auto x_min = m_axis->to_display<Aesthetic::x>(i * dx + x0);
-      auto x_max = m_axis->to_display<Aesthetic::x>((i + 1.f) * dx + x0);
-      auto y_min = w1 * m_axis->to_display<Aesthetic::y>(y1[i]) +
-                   w2 * m_axis->to_display<Aesthetic::y>(y0[i]);
-      auto y_max = m_axis->to_display<Aesthetic::y>(0.f);
-      backend.rect(bfloat2_t({x_min, y_min}, {x_max, y_max}));
-    }
+  const auto to_x = m_axis->map<Aesthetic::x>();
+  const auto y_max = m_axis->to_display<Aesthetic::y>(0.0);
+
+  // map the whole y column to display coordinates
+  size_t n = std::min(m_data[0].rows(), m_data[f].rows());
+  std::vector<float> y1(m_data[f].rows());
+  m_axis->to_display<Aesthetic::y>(m_data[f], y1.data());
+  std::vector<float> y0;
+  if (w2 != 0.0f) {
+    // between two frames
+    y0.resize(m_data[f - 1].rows());
+    m_axis->to_display<Aesthetic::y>(m_data[f - 1], y0.data());
+    n = std::min(n, y0.size());
+  }
+
+  for (size_t i = 0; i < n; ++i) {
+    const auto x_min = to_x(i * dx + x0);
+    const auto x_max = to_x((i + 1.f) * dx + x0);
+    const auto y_min = w2 == 0.0f ? y1[i] : w1 * y1[i] + w2 * y0[i];
+    backend.rect(bfloat2_t({x_min, y_min}, {x_max, y_max}));
   }
 }
 
@@ -72,25 +72,24 @@ void Line::draw_frames(AnimatedBackend &backend) {
   backend.stroke_color(m_style.color());
   backend.stroke_width(m_style.line_width());
 
-  auto to_pixel = [&](auto x, auto y) {
-    return vfloat2_t{m_axis->to_display<Aesthetic::x>(x),
-                     m_axis->to_display<Aesthetic::y>(y)};
-  };
+  const auto to_x = m_axis->map<Aesthetic::x>();
+  const auto to_y = m_axis->map<Aesthetic::y>();
+  auto to_pixel = [&](auto x, auto y) { return vfloat2_t{to_x(x), to_y(y)}; };
 
   // find maximum length of all datasets
   // AnimatedBackend requires that an animated path be the same number of
   // points. Therefore we will find the maximum line length needed, and, for
   // shorter lines, simply repeat the last point the required number of times
-  const int n =
-      std::accumulate(m_data.begin(), m_data.end(), 0,
-                      [](int a, auto b) { return std::max(a, b.rows()); });
+  const size_t n = std::accumulate(
+      m_data.begin(), m_data.end(), size_t(0),
+      [](size_t a, const auto &b) { return std::max(a, b.rows()); });
 
   auto x = m_data[0].begin<Aesthetic::x>();
   auto y = m_data[0].begin<Aesthetic::y>();
-  backend.move_to(to_pixel(x[0], y[0]));
-  for (int i = 1; i < n; ++i) {
-    const int clip_i = std::min(m_data[0].rows() - 1, i);
-    backend.line_to(to_pixel(x[clip_i], y[clip_i]));
+  backend.move_to(to_pixel(x.decode(0), y.decode(0)));
+  for (size_t i = 1; i < n; ++i) {
+    const size_t clip_i = std::min(m_data[0].rows() - 1, i);
+    backend.line_to(to_pixel(x.decode(clip_i), y.decode(clip_i)));
   }
 
   // other frames
@@ -98,10 +97,10 @@ void Line::draw_frames(AnimatedBackend &backend) {
     auto x = m_data[f].begin<Aesthetic::x>();
     auto y = m_data[f].begin<Aesthetic::y>();
     backend.add_animated_path(m_times[f - 1]);
-    backend.move_to(to_pixel(x[0], y[0]));
-    for (int i = 1; i < n; ++i) {
-      const int clip_i = std::min(m_data[f].rows() - 1, i);
-      backend.line_to(to_pixel(x[clip_i], y[clip_i]));
+    backend.move_to(to_pixel(x.decode(0), y.decode(0)));
+    for (size_t i = 1; i < n; ++i) {
+      const size_t clip_i = std::min(m_data[f].rows() - 1, i);
+      backend.line_to(to_pixel(x.decode(clip_i), y.decode(clip_i)));
     }
   }
 
@@ -119,13 +118,14 @@ void Line::draw_anim_highlights(AnimatedBackend &backend) {
     backend.stroke_color(RGBA(0, 0, 0, 0));
     backend.fill_color(color, m_style.color());
 
+    const auto to_x = m_axis->map<Aesthetic::x>();
+    const auto to_y = m_axis->map<Aesthetic::y>();
     auto x = m_data[0].begin<Aesthetic::x>();
     auto y = m_data[0].begin<Aesthetic::y>();
-    for (int i = 0; i < m_data[0].rows(); ++i) {
-      vfloat2_t point = {x[i], y[i]};
-      vfloat2_t point_pixel = {m_axis->to_display<Aesthetic::x>(x[i]),
-                               m_axis->to_display<Aesthetic::y>(y[i])};
-      std::snprintf(buffer, sizeof(buffer), "(%f,%f)", point[0], point[1]);
+    for (size_t i = 0; i < m_data[0].rows(); ++i) {
+      vfloat2_t point_pixel = {to_x(x.decode(i)), to_y(y.decode(i))};
+      std::snprintf(buffer, sizeof(buffer), "(%f,%f)", x.decode(i),
+                    y.decode(i));
       backend.tooltip(
           point_pixel + 2.f * vfloat2_t(m_style.line_width(), -m_style.line_width()), buffer);
       backend.circle(point_pixel, 2 * m_style.line_width());
@@ -141,34 +141,38 @@ template <typename Backend> void Line::draw_plot(Backend &backend) {
   const float w1 = m_frame_info.w1;
   const float w2 = m_frame_info.w2;
 
-  auto to_pixel = [&](auto x, auto y) {
-    return vfloat2_t{m_axis->to_display<Aesthetic::x>(x),
-                     m_axis->to_display<Aesthetic::y>(y)};
+  // map whole columns to display coordinates
+  auto to_pixels = [&](const DataWithAesthetic &data, std::vector<float> &x,
+                       std::vector<float> &y) {
+    x.resize(data.rows());
+    y.resize(data.rows());
+    m_axis->to_display<Aesthetic::x>(data, x.data());
+    m_axis->to_display<Aesthetic::y>(data, y.data());
   };
 
+  std::vector<float> x1, y1;
+  to_pixels(m_data[f], x1, y1);
+
   if (w2 == 0.0f) {
     // exactly on a single frame
-    auto x = m_data[f].begin<Aesthetic::x>();
-    auto y = m_data[f].begin<Aesthetic::y>();
-    backend.move_to(to_pixel(x[0], y[0]));
-    for (int i = 1; i < m_data[0].rows(); ++i) {
-      backend.line_to(to_pixel(x[i], y[i]));
+    backend.move_to({x1[0], y1[0]});
+    for (size_t i = 1; i < x1.size(); ++i) {
+      backend.line_to({x1[i], y1[i]});
     }
   } else {
     // between two frames
-    auto x0 = m_data[f - 1].begin<Aesthetic::x>();
-    auto y0 = m_data[f - 1].begin<Aesthetic::y>();
-    auto x1 = m_data[f].begin<Aesthetic::x>();
-    auto y1 = m_data[f].begin<Aesthetic::y>();
-    backend.move_to(w1 * to_pixel(x1[0], y1[0]) + w2 * to_pixel(x0[0], y0[0]));
-    const int last_i = std::min(m_data[f - 1].rows(), m_data[f].rows());
-    for (int i = 1; i < last_i; ++i) {
-      backend.line_to(w1 * to_pixel(x1[i], y1[i]) +
-                      w2 * to_pixel(x0[i], y0[i]));
+    std::vector<float> x0, y0;
+    to_pixels(m_data[f - 1], x0, y0);
+    auto interpolate = [&](const size_t i1, const size_t i0) {
+      return vfloat2_t{w1 * x1[i1] + w2 * x0[i0], w1 * y1[i1] + w2 * y0[i0]};
+    };
+    backend.move_to(interpolate(0, 0));
+    const size_t last_i = std::min(x0.size(), x1.size());
+    for (size_t i = 1; i < last_i; ++i) {
+      backend.line_to(interpolate(i, i));
     }
-    if (m_data[f].rows() > last_i) {
-      backend.line_to(w1 * to_pixel(x1[last_i], y1[last_i]) +
-                      w2 * to_pixel(x0[last_i - 1], y0[last_i - 1]));
+    if (x1.size() > last_i) {
+      backend.line_to(interpolate(last_i, last_i - 1));
     }
   }
 
@@ -199,15 +203,39 @@ template <typename Backend> void Line::draw_highlights(Backend &backend) {
     float min_r2 = std::numeric_limits<float>::max();
     vfloat2_t min_point{};
     // exactly on a frame
-    auto x = m_data[m_frame_info.frame_above].begin<Aesthetic::x>();
-    auto y = m_data[m_frame_info.frame_above].begin<Aesthetic::y>();
-    for (int i = 0; i < m_data[0].rows(); ++i) {
-      const vfloat2_t point = {x[i], y[i]};
+    const auto &data = m_data[m_frame_info.frame_above];
+    const auto n = static_cast<std::ptrdiff_t>(data.rows());
+    auto x = data.begin<Aesthetic::x>();
+    auto y = data.begin<Aesthetic::y>();
+    auto visit = [&](const std::ptrdiff_t i) {
+      const vfloat2_t point = {static_cast<float>(x.decode(i)),
+                               static_cast<float>(y.decode(i))};
       auto point_r2 = (point - pos).squaredNorm();
       if (point_r2 < min_r2) {
         min_point = point;
         min_r2 = point_r2;
       }
+    };
+    auto x_r2 = [&](const std::ptrdiff_t i) {
+      return std::pow(static_cast<float>(x.decode(i)) - pos[0], 2.f);
+    };
+
+    if (data.is_sorted<Aesthetic::x>()) {
+      // binary search for the mouse x position, then search outwards until
+      // the x distance alone is further than the closest point found
+      const auto start =
+          std::lower_bound(x, x + n, static_cast<float>(pos[0] - x.offset())) -
+          x;
+      for (auto i = start; i < n && x_r2(i) < min_r2; ++i) {
+        visit(i);
+      }
+      for (auto i = start - 1; i >= 0 && x_r2(i) < min_r2; --i) {
+        visit(i);
+      }
+    } else {
+      for (std::ptrdiff_t i = 0; i < n; ++i) {
+        visit(i);
+      }
     }
 
     // define search radius
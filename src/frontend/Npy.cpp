@@ -0,0 +1,460 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include "frontend/Npy.hpp"
+#include "util/MappedFile.hpp"
+
+namespace trase {
+
+namespace {
+
+/// a value of the Python literal that forms the header of a .npy file
+struct PyValue {
+  enum Type { String, Number, Bool, List, Dict } type{Number};
+  std::string string;
+  long long number{0};
+  std::vector<PyValue> items;
+  std::vector<std::pair<std::string, PyValue>> dict;
+
+  const PyValue &at(const std::string &key) const {
+    for (const auto &i : dict) {
+      if (i.first == key) {
+        return i.second;
+      }
+    }
+    throw Exception("npy header has no " + key);
+  }
+};
+
+/// parses the subset of Python literals used in .npy headers, i.e. dicts,
+/// lists, tuples (parsed as lists), strings, integers and booleans
+class PyParser {
+  const char *m_p;
+  const char *m_end;
+
+public:
+  PyParser(const char *begin, const char *end) : m_p(begin), m_end(end) {}
+
+  PyValue parse() {
+    skip_space();
+    if (m_p == m_end) {
+      throw Exception("unexpected end of npy header");
+    }
+    PyValue value;
+    const char c = *m_p;
+    if (c == '{') {
+      value.type = PyValue::Dict;
+      ++m_p;
+      while (!close('}')) {
+        PyValue key = parse();
+        expect(':');
+        value.dict.emplace_back(key.string, parse());
+      }
+    } else if (c == '[' || c == '(') {
+      value.type = PyValue::List;
+      ++m_p;
+      while (!close(c == '[' ? ']' : ')')) {
+        value.items.push_back(parse());
+      }
+    } else if (c == '\'' || c == '"') {
+      value.type = PyValue::String;
+      const char *end = std::find(++m_p, m_end, c);
+      value.string.assign(m_p, end);
+      m_p = end == m_end ? end : end + 1;
+    } else if (std::isdigit(static_cast<unsigned char>(c)) || c == '-') {
+      value.type = PyValue::Number;
+      const char *begin = m_p++;
+      while (m_p != m_end && std::isdigit(static_cast<unsigned char>(*m_p))) {
+        ++m_p;
+      }
+      value.number = std::stoll(std::string(begin, m_p));
+    } else {
+      value.type = PyValue::Bool;
+      const char *begin = m_p;
+      while (m_p != m_end && std::isalpha(static_cast<unsigned char>(*m_p))) {
+        ++m_p;
+      }
+      const std::string word(begin, m_p);
+      if (word != "True" && word != "False") {
+        throw Exception("unexpected " + word + " in npy header");
+      }
+      value.number = word == "True";
+    }
+    return value;
+  }
+
+private:
+  void skip_space() {
+    while (m_p != m_end && std::isspace(static_cast<unsigned char>(*m_p))) {
+      ++m_p;
+    }
+  }
+
+  void expect(const char c) {
+    skip_space();
+    if (m_p == m_end || *m_p != c) {
+      throw Exception(std::string("expected ") + c + " in npy header");
+    }
+    ++m_p;
+  }
+
+  /// skips a separating comma, and returns true (skipping @p c) if the
+  /// next character is @p c
+  bool close(const char c) {
+    skip_space();
+    if (m_p != m_end && *m_p == ',') {
+      ++m_p;
+      skip_space();
+    }
+    if (m_p != m_end && *m_p == c) {
+      ++m_p;
+      return true;
+    }
+    return false;
+  }
+};
+
+/// a field of a (structured) NumPy array
+struct NpyField {
+  std::string name;
+  /// the kind of the field, 'f', 'i', 'u', 'b', 'V'...
+  char kind;
+  /// the size of the field in bytes
+  size_t size;
+  /// the offset of the field in each row
+  size_t offset;
+  /// true if the byte order is different to the host
+  bool swap;
+};
+
+bool little_endian() {
+  const uint16_t one = 1;
+  uint8_t first;
+  std::memcpy(&first, &one, 1);
+  return first == 1;
+}
+
+/// parses a NumPy type string, e.g. '<f4'
+NpyField parse_type(const std::string &type) {
+  if (type.size() < 3) {
+    throw Exception("unsupported npy type " + type);
+  }
+  NpyField field;
+  field.kind = type[1];
+  field.size = std::stoul(type.substr(2));
+  field.offset = 0;
+  field.swap = (type[0] == '>' && little_endian()) ||
+               (type[0] == '<' && !little_endian());
+  return field;
+}
+
+/// reads a value of type T, reversing the byte order if @p swap is true
+template <typename T> T read(const char *p, const bool swap) {
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, p, sizeof(T));
+  if (swap) {
+    std::reverse(bytes, bytes + sizeof(T));
+  }
+  T value;
+  std::memcpy(&value, bytes, sizeof(T));
+  return value;
+}
+
+/// converts @p n values of type T (each @p stride bytes apart) to a float
+/// column in a single pass. If @p encode is true the column is offset encoded
+/// relative to its first (finite) element
+template <typename T>
+Column convert(const char *p, const size_t n, const size_t stride,
+               const bool swap, const bool encode) {
+  std::vector<float> column(n);
+  double offset = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    const auto value = static_cast<double>(read<T>(p + i * stride, swap));
+    if (i == 0 && encode && std::isfinite(value)) {
+      offset = value;
+    }
+    column[i] = static_cast<float>(value - offset);
+  }
+  return Column(std::move(column), offset);
+}
+
+/// returns the column of @p n elements of type @p field starting at @p p,
+/// with @p stride bytes between consecutive elements
+Column make_column(const char *p, const size_t n, const size_t stride,
+                   const NpyField &field,
+                   const std::shared_ptr<const MappedFile> &owner) {
+  const bool encode = field.kind == 'i' || field.kind == 'u' ||
+                      (field.kind == 'f' && field.size == 8);
+  const auto key = std::make_pair(field.kind, field.size);
+  if (key == std::make_pair('f', size_t(4))) {
+    if (!field.swap && reinterpret_cast<uintptr_t>(p) % alignof(float) == 0 &&
+        stride % sizeof(float) == 0) {
+      // no conversion needed, use the mapped file directly
+      return Column(reinterpret_cast<const float *>(p), n,
+                    static_cast<std::ptrdiff_t>(stride / sizeof(float)),
+                    owner);
+    }
+    return convert<float>(p, n, stride, field.swap, encode);
+  } else if (key == std::make_pair('f', size_t(8))) {
+    return convert<double>(p, n, stride, field.swap, encode);
+  } else if (key == std::make_pair('b', size_t(1)) ||
+             key == std::make_pair('u', size_t(1))) {
+    return convert<uint8_t>(p, n, stride, field.swap, encode);
+  } else if (key == std::make_pair('i', size_t(1))) {
+    return convert<int8_t>(p, n, stride, field.swap, encode);
+  } else if (key == std::make_pair('i', size_t(2))) {
+    return convert<int16_t>(p, n, stride, field.swap, encode);
+  } else if (key == std::make_pair('u', size_t(2))) {
+    return convert<uint16_t>(p, n, stride, field.swap, encode);
+  } else if (key == std::make_pair('i', size_t(4))) {
+    return convert<int32_t>(p, n, stride, field.swap, encode);
+  } else if (key == std::make_pair('u', size_t(4))) {
+    return convert<uint32_t>(p, n, stride, field.swap, encode);
+  } else if (key == std::make_pair('i', size_t(8))) {
+    return convert<int64_t>(p, n, stride, field.swap, encode);
+  } else if (key == std::make_pair('u', size_t(8))) {
+    return convert<uint64_t>(p, n, stride, field.swap, encode);
+  }
+  throw Exception(std::string("unsupported npy type ") + field.kind +
+                  std::to_string(field.size));
+}
+
+/// parses the .npy file of @p size bytes at @p data, which is kept alive by
+/// @p owner
+NpyData parse_npy(const char *data, const size_t size,
+                  const std::shared_ptr<const MappedFile> &owner,
+                  const std::string &filename) {
+  const char magic[] = "\x93NUMPY";
+  if (size < 10 || std::memcmp(data, magic, 6) != 0) {
+    throw Exception(filename + " is not a npy file");
+  }
+
+  // version 1 has a 2 byte header length, later versions 4 bytes
+  const auto major = static_cast<uint8_t>(data[6]);
+  const size_t header_start = major == 1 ? 10 : 12;
+  const size_t header_size =
+      major == 1 ? read<uint16_t>(data + 8, !little_endian())
+                 : read<uint32_t>(data + 8, !little_endian());
+  if (header_start + header_size > size) {
+    throw Exception(filename + " is truncated");
+  }
+  const PyValue header = PyParser(data + header_start,
+                                  data + header_start + header_size)
+                             .parse();
+
+  // fields of each row, with their offsets
+  std::vector<NpyField> fields;
+  size_t row_size = 0;
+  const PyValue &descr = header.at("descr");
+  const bool structured = descr.type == PyValue::List;
+  if (structured) {
+    for (const auto &item : descr.items) {
+      if (item.items.size() != 2 || item.items[1].type != PyValue::String) {
+        throw Exception("unsupported npy field in " + filename);
+      }
+      // the name can be a (title, name) pair
+      const PyValue &name = item.items[0];
+      NpyField field = parse_type(item.items[1].string);
+      field.name = name.type == PyValue::List ? name.items.at(1).string
+                                              : name.string;
+      field.offset = row_size;
+      row_size += field.size;
+      // unnamed void fields are padding
+      if (field.kind != 'V') {
+        fields.push_back(field);
+      }
+    }
+  } else {
+    fields.push_back(parse_type(descr.string));
+    row_size = fields[0].size;
+  }
+
+  std::vector<size_t> shape;
+  for (const auto &i : header.at("shape").items) {
+    shape.push_back(static_cast<size_t>(i.number));
+  }
+  if (shape.size() > 2 || (structured && shape.size() > 1)) {
+    throw Exception("unsupported npy shape in " + filename);
+  }
+  const size_t rows = shape.empty() ? 1 : shape[0];
+  const size_t cols = shape.size() == 2 ? shape[1] : 1;
+  const bool fortran_order = header.at("fortran_order").number != 0;
+
+  const char *begin = data + header_start + header_size;
+  if (rows * cols * row_size > size - header_start - header_size) {
+    throw Exception(filename + " is truncated");
+  }
+
+  NpyData npy;
+  npy.data = std::make_shared<RawData>();
+  if (structured) {
+    for (const auto &field : fields) {
+      npy.data->add_column(
+          make_column(begin + field.offset, rows, row_size, field, owner));
+      npy.names.push_back(field.name);
+    }
+  } else {
+    for (size_t j = 0; j < cols; ++j) {
+      const size_t offset = fortran_order ? j * rows : j;
+      const size_t stride = fortran_order ? 1 : cols;
+      npy.data->add_column(make_column(begin + offset * row_size, rows,
+                                       stride * row_size, fields[0], owner));
+      npy.names.push_back(std::to_string(j));
+    }
+  }
+  return npy;
+}
+
+} // namespace
+
+size_t NpyData::column(const std::string &name) const {
+  auto i = std::find(names.begin(), names.end(), name);
+  if (i == names.end()) {
+    throw Exception("no column called " + name);
+  }
+  return static_cast<size_t>(i - names.begin());
+}
+
+NpyData load_npy(const std::string &filename) {
+  auto file = std::make_shared<const MappedFile>(filename);
+  return parse_npy(file->data(), file->size(), file, filename);
+}
+
+std::map<std::string, NpyData> load_npz(const std::string &filename) {
+  auto file = std::make_shared<const MappedFile>(filename);
+  const char *data = file->data();
+  const size_t size = file->size();
+  const bool swap = !little_endian();
+
+  // find the end of central directory record, which is followed by a comment
+  // of up to 64k
+  const uint32_t end_signature = 0x06054b50;
+  size_t end = size < 22 ? size : size - 22;
+  while (end < size && end + 65536 + 22 >= size &&
+         read<uint32_t>(data + end, swap) != end_signature) {
+    --end;
+  }
+  if (end >= size || read<uint32_t>(data + end, swap) != end_signature) {
+    throw Exception(filename + " is not a npz file");
+  }
+
+  size_t entries = read<uint16_t>(data + end + 10, swap);
+  size_t entry = read<uint32_t>(data + end + 16, swap);
+
+  // a zip64 file (e.g. one holding more than 4GB) has a locator before the
+  // end of central directory record, pointing to a zip64 record with the
+  // 64-bit number and offset of the entries
+  if (end >= 20 && read<uint32_t>(data + end - 20, swap) == 0x07064b50) {
+    const auto record = read<uint64_t>(data + end - 12, swap);
+    if (record + 56 > end ||
+        read<uint32_t>(data + record, swap) != 0x06064b50) {
+      throw Exception(filename + " has an invalid zip64 end of central "
+                                 "directory");
+    }
+    entries = static_cast<size_t>(read<uint64_t>(data + record + 32, swap));
+    entry = static_cast<size_t>(read<uint64_t>(data + record + 48, swap));
+  }
+
+  std::map<std::string, NpyData> arrays;
+  for (size_t i = 0; i < entries; ++i) {
+    if (entry + 46 > size || read<uint32_t>(data + entry, swap) != 0x02014b50) {
+      throw Exception(filename + " has an invalid central directory");
+    }
+    const auto method = read<uint16_t>(data + entry + 10, swap);
+    size_t stored_size = read<uint32_t>(data + entry + 20, swap);
+    size_t original_size = read<uint32_t>(data + entry + 24, swap);
+    const size_t name_size = read<uint16_t>(data + entry + 28, swap);
+    const size_t extra_size = read<uint16_t>(data + entry + 30, swap);
+    const size_t comment_size = read<uint16_t>(data + entry + 32, swap);
+    size_t local = read<uint32_t>(data + entry + 42, swap);
+    if (entry + 46 + name_size + extra_size > size) {
+      throw Exception(filename + " has an invalid central directory");
+    }
+    std::string name(data + entry + 46, name_size);
+
+    // sizes and offsets that do not fit in 32 bits are 0xffffffff, and are
+    // given (in this order) by the zip64 extended information extra field
+    const char *extra = data + entry + 46 + name_size;
+    const char *extra_end = extra + extra_size;
+    while (extra + 4 <= extra_end) {
+      const auto id = read<uint16_t>(extra, swap);
+      const char *field = extra + 4;
+      extra = field + read<uint16_t>(extra + 2, swap);
+      if (id != 0x0001) {
+        continue;
+      }
+      for (size_t *value : {&original_size, &stored_size, &local}) {
+        if (*value == 0xffffffff) {
+          if (field + 8 > extra || extra > extra_end) {
+            throw Exception(filename + " has an invalid zip64 extra field");
+          }
+          *value = static_cast<size_t>(read<uint64_t>(field, swap));
+          field += 8;
+        }
+      }
+    }
+    entry += 46 + name_size + extra_size + comment_size;
+
+    if (method != 0) {
+      throw Exception(filename + " is compressed, only uncompressed npz files "
+                                 "are supported");
+    }
+    if (original_size != stored_size) {
+      throw Exception(filename + " has an invalid central directory");
+    }
+    if (local + 30 > size) {
+      throw Exception(filename + " is truncated");
+    }
+    const size_t start = local + 30 + read<uint16_t>(data + local + 26, swap) +
+                         read<uint16_t>(data + local + 28, swap);
+    if (start > size || stored_size > size - start) {
+      throw Exception(filename + " is truncated");
+    }
+
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".npy") == 0) {
+      name.resize(name.size() - 4);
+    }
+    arrays[name] = parse_npy(data + start, stored_size, file,
+                             filename + "/" + name);
+  }
+  return arrays;
+}
+
+} // namespace trase
@@ -0,0 +1,86 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file Npy.hpp
+
+#ifndef NPY_H_
+#define NPY_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "frontend/Data.hpp"
+
+namespace trase {
+
+/// The columns of a NumPy array, see load_npy()
+struct NpyData {
+  /// one column for each field of a structured array, or for each column of a
+  /// 1D or 2D array
+  std::shared_ptr<RawData> data;
+
+  /// the name of each column of data. These are the field names of a
+  /// structured array, or "0", "1", ... otherwise
+  std::vector<std::string> names;
+
+  /// returns the index of the column called @p name, which can be passed to
+  /// DataWithAesthetic::bind() to map the column to an aesthetic. Throws
+  /// trase::Exception if there is no such column
+  size_t column(const std::string &name) const;
+};
+
+/// loads a NumPy .npy file, which is memory mapped rather than read
+///
+/// 1D arrays give a single column, 2D arrays give one column for each column
+/// of the array, and structured (record) arrays give one column for each
+/// field. Little-endian float32 data is used directly from the mapped file
+/// without copying, also for the columns of a 2D array and the fields of a
+/// structured array (using the stride between rows). Other types (bool,
+/// integers, float64 and big-endian data) are converted to float columns in a
+/// single pass. Integer and float64 columns are offset encoded (see Column)
+/// relative to their first element, to keep their precision
+///
+/// Throws trase::Exception if the file cannot be read or has an unsupported
+/// type
+NpyData load_npy(const std::string &filename);
+
+/// loads each array of a NumPy .npz file (see load_npy()), keyed by the array
+/// names. The file is memory mapped, only uncompressed archives (i.e. written
+/// by numpy.savez rather than numpy.savez_compressed) are supported
+std::map<std::string, NpyData> load_npz(const std::string &filename);
+
+} // namespace trase
+
+#endif // NPY_H_
@@ -88,7 +88,7 @@ public:
 
 private:
   void validate_frames(const bool have_size, const bool have_color,
-                       const int n);
+                       const size_t n);
   template <typename AnimatedBackend>
   void draw_frames(AnimatedBackend &backend);
   template <typename Backend> void draw_plot(Backend &backend);
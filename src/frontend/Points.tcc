@@ -32,6 +32,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "frontend/Points.hpp"
+
+#include <algorithm>
+
 #include "util/Exception.hpp"
 
 namespace trase {
@@ -131,11 +134,11 @@ void Points::draw_legend(Backend &backend, const float time,
 }
 
 void Points::validate_frames(const bool have_size, const bool have_color,
-                             const int n) {
+                             const size_t n) {
   for (size_t f = 0; f < m_times.size(); ++f) {
     const bool this_frame_have_color = m_data[f].has<Aesthetic::color>();
     const bool this_frame_have_size = m_data[f].has<Aesthetic::size>();
-    const int this_frame_n = m_data[f].rows();
+    const size_t this_frame_n = m_data[f].rows();
 
     if (this_frame_have_color != have_color) {
       throw Exception("Frames found with and without color Aesthetic. Points "
@@ -161,33 +164,41 @@ void Points::draw_frames(AnimatedBackend &backend) {
   // WARNING: do not make these const or gcc v5 seg faults on the lambda!!
   bool have_color = m_data[0].has<Aesthetic::color>();
   bool have_size = m_data[0].has<Aesthetic::size>();
-  const int n = m_data[0].rows();
+  const size_t n = m_data[0].rows();
 
   validate_frames(have_size, have_color, n);
 
+  const auto to_x = m_axis->map<Aesthetic::x>();
+  const auto to_y = m_axis->map<Aesthetic::y>();
+  const auto to_size = m_axis->map<Aesthetic::size>();
+  const auto to_color = m_axis->map<Aesthetic::color>();
   auto to_pixel = [&](auto x, auto y, auto s) {
     // if color or size is not provided use the bottom of the scale
-    return Vector<float, 3>{m_axis->to_display<Aesthetic::x>(x),
-                            m_axis->to_display<Aesthetic::y>(y),
-                            have_size
-                                ? m_axis->to_display<Aesthetic::size>(s)
-                                : (m_pixels.bmax[1] - m_pixels.bmin[1]) / 80.f};
+    return Vector<float, 3>{
+        to_x(x), to_y(y),
+        have_size ? to_size(s) : (m_pixels.bmax[1] - m_pixels.bmin[1]) / 80.f};
   };
 
+  // get the column iterators of every frame once, outside the loop over
+  // points. if color or size not provided use x here, not used
+  std::vector<ColumnIterator> x, y, size, color;
+  for (const auto &data : m_data) {
+    x.push_back(data.begin<Aesthetic::x>());
+    y.push_back(data.begin<Aesthetic::y>());
+    size.push_back(have_size ? data.begin<Aesthetic::size>() : x.back());
+    color.push_back(have_color ? data.begin<Aesthetic::color>() : x.back());
+  }
+
   backend.stroke_width(0);
   backend.fill_color(m_style.color());
-  for (int i = 0; i < n; ++i) {
+  for (size_t i = 0; i < n; ++i) {
     for (size_t f = 0; f < m_times.size(); ++f) {
-      auto p =
-          to_pixel(m_data[f].begin<Aesthetic::x>()[i],
-                   m_data[f].begin<Aesthetic::y>()[i],
-                   have_size ? m_data[f].begin<Aesthetic::size>()[i] : 0.f);
+      auto p = to_pixel(x[f].decode(i), y[f].decode(i), size[f].decode(i));
 
       backend.add_animated_circle({p[0], p[1]}, p[2], m_times[f]);
       if (have_color) {
-        const auto color = m_axis->to_display<Aesthetic::color>(
-            m_data[f].begin<Aesthetic::color>()[i]);
-        backend.add_animated_fill(m_colormap->to_color(color));
+        const auto c = to_color(color[f].decode(i));
+        backend.add_animated_fill(m_colormap->to_color(c));
       }
     }
     backend.end_animated_circle();
@@ -202,58 +213,64 @@ template <typename Backend> void Points::draw_plot(Backend &backend) {
 
   bool have_color = m_data[f].has<Aesthetic::color>();
   bool have_size = m_data[f].has<Aesthetic::size>();
-  const int n = m_data[0].rows();
+  const size_t n = m_data[0].rows();
 
   validate_frames(have_size, have_color, n);
 
   backend.stroke_width(0);
   backend.fill_color(m_style.color());
 
-  auto to_pixel = [&](auto x, auto y, auto s) {
-    // if color or size is not provided use the bottom of the scale
-    return Vector<float, 3>{m_axis->to_display<Aesthetic::x>(x),
-                            m_axis->to_display<Aesthetic::y>(y),
-                            have_size
-                                ? m_axis->to_display<Aesthetic::size>(s)
-                                : (m_pixels.bmax[1] - m_pixels.bmin[1]) / 80.f};
+  // map the columns to display coordinates a chunk of rows at a time, so that
+  // the buffers are reused and stay small however many rows there are. if
+  // color or size is not provided use the bottom of the scale
+  const float default_size = (m_pixels.bmax[1] - m_pixels.bmin[1]) / 80.f;
+  const size_t chunk = std::min<size_t>(n, 1 << 16);
+  auto to_pixels = [&](const DataWithAesthetic &data, const size_t first,
+                       const size_t last, std::vector<float> &x,
+                       std::vector<float> &y, std::vector<float> &size,
+                       std::vector<float> &color) {
+    m_axis->to_display<Aesthetic::x>(data, first, last, x.data());
+    m_axis->to_display<Aesthetic::y>(data, first, last, y.data());
+    if (have_size) {
+      m_axis->to_display<Aesthetic::size>(data, first, last, size.data());
+    }
+    if (have_color) {
+      m_axis->to_display<Aesthetic::color>(data, first, last, color.data());
+    }
   };
 
-  if (w2 == 0.0f) {
-    // exactly on a single frame
-    auto x = m_data[f].begin<Aesthetic::x>();
-    auto y = m_data[f].begin<Aesthetic::y>();
-    // if color or size not provided give a dummy iterator here, not used
-    auto color = have_color ? m_data[f].begin<Aesthetic::color>() : x;
-    auto size = have_size ? m_data[f].begin<Aesthetic::size>() : x;
-    for (int i = 0; i < m_data[0].rows(); ++i) {
-      const auto p = to_pixel(x[i], y[i], size[i]);
-      if (have_color) {
-        const auto c = m_axis->to_display<Aesthetic::color>(color[i]);
-        backend.fill_color(m_colormap->to_color(c));
+  std::vector<float> x1(chunk), y1(chunk), size1(chunk, default_size),
+      color1(have_color ? chunk : 0);
+  std::vector<float> x0, y0, size0, color0;
+  if (w2 != 0.0f) {
+    x0.resize(chunk);
+    y0.resize(chunk);
+    size0.assign(chunk, default_size);
+    color0.resize(color1.size());
+  }
+
+  for (size_t first = 0; first < n; first += chunk) {
+    const size_t last = std::min(n, first + chunk);
+    to_pixels(m_data[f], first, last, x1, y1, size1, color1);
+    if (w2 == 0.0f) {
+      // exactly on a single frame
+      for (size_t i = 0; i < last - first; ++i) {
+        if (have_color) {
+          backend.fill_color(m_colormap->to_color(color1[i]));
+        }
+        backend.circle({x1[i], y1[i]}, size1[i]);
       }
-      backend.circle({p[0], p[1]}, p[2]);
-    }
-  } else {
-    // between two frames
-    auto x0 = m_data[f - 1].begin<Aesthetic::x>();
-    auto y0 = m_data[f - 1].begin<Aesthetic::y>();
-    // if color or size not provided give a dummy iterator here, not used
-    auto color0 = have_color ? m_data[f - 1].begin<Aesthetic::color>() : x0;
-    auto size0 = have_size ? m_data[f - 1].begin<Aesthetic::size>() : x0;
-    auto x1 = m_data[f].begin<Aesthetic::x>();
-    auto y1 = m_data[f].begin<Aesthetic::y>();
-    // if color or size not provided give a dummy iterator here, not used
-    auto color1 = have_color ? m_data[f].begin<Aesthetic::color>() : x1;
-    auto size1 = have_size ? m_data[f].begin<Aesthetic::size>() : x1;
-    for (int i = 0; i < m_data[0].rows(); ++i) {
-      const auto p = w1 * to_pixel(x1[i], y1[i], size1[i]) +
-                     w2 * to_pixel(x0[i], y0[i], size0[i]);
-      if (have_color) {
-        const auto c = m_axis->to_display<Aesthetic::color>(w1 * color1[i] +
-                                                            w2 * color0[i]);
-        backend.fill_color(m_colormap->to_color(c));
+    } else {
+      // between two frames
+      to_pixels(m_data[f - 1], first, last, x0, y0, size0, color0);
+      for (size_t i = 0; i < last - first; ++i) {
+        if (have_color) {
+          const auto c = w1 * color1[i] + w2 * color0[i];
+          backend.fill_color(m_colormap->to_color(c));
+        }
+        backend.circle({w1 * x1[i] + w2 * x0[i], w1 * y1[i] + w2 * y0[i]},
+                       w1 * size1[i] + w2 * size0[i]);
       }
-      backend.circle({p[0], p[1]}, p[2]);
     }
   }
 }
@@ -174,11 +174,11 @@ void Rectangle::draw_legend(Backend &backend, const float time,
 }
 
 void Rectangle::validate_frames(const bool have_color, const bool have_fill,
-                                const int n) {
+                                const size_t n) {
   for (size_t f = 0; f < m_times.size(); ++f) {
     const bool this_frame_have_color = m_data[f].has<Aesthetic::color>();
     const bool this_frame_have_fill = m_data[f].has<Aesthetic::fill>();
-    const int this_frame_n = m_data[f].rows();
+    const size_t this_frame_n = m_data[f].rows();
 
     if (this_frame_have_color != have_color) {
       throw Exception(
@@ -207,38 +207,46 @@ void Rectangle::draw_frames(AnimatedBackend &backend) {
   // WARNING: do not make these const or gcc v5 seg faults on the lambda!!
   bool have_color = m_data[0].has<Aesthetic::color>();
   bool have_fill = m_data[0].has<Aesthetic::fill>();
-  const int n = m_data[0].rows();
+  const size_t n = m_data[0].rows();
 
   validate_frames(have_color, have_fill, n);
 
+  const auto to_x = m_axis->map<Aesthetic::xmin>();
+  const auto to_y = m_axis->map<Aesthetic::ymin>();
+  const auto to_color = m_axis->map<Aesthetic::color>();
+  const auto to_fill = m_axis->map<Aesthetic::fill>();
   auto to_pixel = [&](auto xmin, auto ymin, auto xmax, auto ymax) {
-    // if color is not provided use the bottom of the scale
-    return Vector<float, 4>{m_axis->to_display<Aesthetic::xmin>(xmin),
-                            m_axis->to_display<Aesthetic::ymin>(ymin),
-                            m_axis->to_display<Aesthetic::xmax>(xmax),
-                            m_axis->to_display<Aesthetic::ymax>(ymax)};
+    return Vector<float, 4>{to_x(xmin), to_y(ymin), to_x(xmax), to_y(ymax)};
   };
 
+  // get the column iterators of every frame once, outside the loop over
+  // rectangles. if color or fill not provided use xmin here, not used
+  std::vector<ColumnIterator> xmin, ymin, xmax, ymax, color, fill;
+  for (const auto &data : m_data) {
+    xmin.push_back(data.begin<Aesthetic::xmin>());
+    ymin.push_back(data.begin<Aesthetic::ymin>());
+    xmax.push_back(data.begin<Aesthetic::xmax>());
+    ymax.push_back(data.begin<Aesthetic::ymax>());
+    color.push_back(have_color ? data.begin<Aesthetic::color>() : xmin.back());
+    fill.push_back(have_fill ? data.begin<Aesthetic::fill>() : xmin.back());
+  }
+
   backend.stroke_width(m_style.line_width());
   backend.fill_color(m_style.color());
   backend.stroke_color(m_style.color());
-  for (int i = 0; i < n; ++i) {
+  for (size_t i = 0; i < n; ++i) {
     for (size_t f = 0; f < m_times.size(); ++f) {
-      auto p = to_pixel(m_data[f].begin<Aesthetic::xmin>()[i],
-                        m_data[f].begin<Aesthetic::ymin>()[i],
-                        m_data[f].begin<Aesthetic::xmax>()[i],
-                        m_data[f].begin<Aesthetic::ymax>()[i]);
+      auto p = to_pixel(xmin[f].decode(i), ymin[f].decode(i),
+                        xmax[f].decode(i), ymax[f].decode(i));
 
       backend.add_animated_rect({{p[0], p[3]}, {p[2], p[1]}}, m_times[f]);
       if (have_color) {
-        const auto color = m_axis->to_display<Aesthetic::color>(
-            m_data[f].begin<Aesthetic::color>()[i]);
-        backend.add_animated_stroke(m_colormap->to_color(color));
+        const auto c = to_color(color[f].decode(i));
+        backend.add_animated_stroke(m_colormap->to_color(c));
       }
       if (have_fill) {
-        const auto fill = m_axis->to_display<Aesthetic::fill>(
-            m_data[f].begin<Aesthetic::fill>()[i]);
-        backend.add_animated_fill(m_colormap->to_color(fill));
+        const auto c = to_fill(fill[f].decode(i));
+        backend.add_animated_fill(m_colormap->to_color(c));
       }
     }
     backend.end_animated_rect();
@@ -253,7 +261,7 @@ template <typename Backend> void Rectangle::draw_plot(Backend &backend) {
 
   bool have_color = m_data[f].has<Aesthetic::color>();
   bool have_fill = m_data[f].has<Aesthetic::fill>();
-  const int n = m_data[0].rows();
+  const size_t n = m_data[0].rows();
 
   validate_frames(have_color, have_fill, n);
 
@@ -277,14 +285,15 @@ template <typename Backend> void Rectangle::draw_plot(Backend &backend) {
     // if color not provided give a dummy iterator here, not used
     auto color = have_color ? m_data[f].begin<Aesthetic::color>() : xmin;
     auto fill = have_fill ? m_data[f].begin<Aesthetic::fill>() : xmin;
-    for (int i = 0; i < m_data[0].rows(); ++i) {
-      const auto p = to_pixel(xmin[i], ymin[i], xmax[i], ymax[i]);
+    for (size_t i = 0; i < m_data[0].rows(); ++i) {
+      const auto p = to_pixel(xmin.decode(i), ymin.decode(i), xmax.decode(i),
+                              ymax.decode(i));
       if (have_color) {
-        const auto c = m_axis->to_display<Aesthetic::color>(color[i]);
+        const auto c = m_axis->to_display<Aesthetic::color>(color.decode(i));
         backend.stroke_color(m_colormap->to_color(c));
       }
       if (have_fill) {
-        const auto f = m_axis->to_display<Aesthetic::fill>(fill[i]);
+        const auto f = m_axis->to_display<Aesthetic::fill>(fill.decode(i));
         backend.fill_color(m_colormap->to_color(f));
       }
       backend.rect({{p[0], p[3]}, {p[2], p[1]}});
@@ -305,17 +314,19 @@ template <typename Backend> void Rectangle::draw_plot(Backend &backend) {
     // if color not provided give a dummy iterator here, not used
     auto color1 = have_color ? m_data[f].begin<Aesthetic::color>() : xmin0;
     auto fill1 = have_fill ? m_data[f].begin<Aesthetic::fill>() : xmin0;
-    for (int i = 0; i < m_data[0].rows(); ++i) {
-      const auto p = w1 * to_pixel(xmin1[i], ymin1[i], xmax1[i], ymax1[i]) +
-                     w2 * to_pixel(xmin0[i], ymin0[i], xmax0[i], ymax0[i]);
+    for (size_t i = 0; i < m_data[0].rows(); ++i) {
+      const auto p = w1 * to_pixel(xmin1.decode(i), ymin1.decode(i),
+                                   xmax1.decode(i), ymax1.decode(i)) +
+                     w2 * to_pixel(xmin0.decode(i), ymin0.decode(i),
+                                   xmax0.decode(i), ymax0.decode(i));
       if (have_color) {
-        const auto color = m_axis->to_display<Aesthetic::color>(w1 * color1[i] +
-                                                                w2 * color0[i]);
+        const auto color = m_axis->to_display<Aesthetic::color>(
+            w1 * color1.decode(i) + w2 * color0.decode(i));
         backend.stroke_color(m_colormap->to_color(color));
       }
       if (have_fill) {
-        const auto fill =
-            m_axis->to_display<Aesthetic::fill>(w1 * fill1[i] + w2 * fill0[i]);
+        const auto fill = m_axis->to_display<Aesthetic::fill>(
+            w1 * fill1.decode(i) + w2 * fill0.decode(i));
         backend.fill_color(m_colormap->to_color(fill));
       }
       backend.rect({{p[0], p[3]}, {p[2], p[1]}});
@@ -56,15 +56,20 @@ DataWithAesthetic BinX::operator()(const DataWithAesthetic &data) {
     return create_data().y(y);
   }
 
-  auto minmax = std::minmax_element(x_begin, x_end);
+  // the min/max is cached by the column, so this does not iterate over x
+  const auto minmax = data.minmax<Aesthetic::x>();
+
+  // offset for offset encoded columns, the stored x values are relative to
+  // this (note that the standard deviation below is not affected by it)
+  const double offset = x_begin.offset();
 
   if (m_span.is_empty()) {
     // increase the span slightly so round-off doesn't cause points to fall
     // outside the domain
-    m_span.bmin[0] =
-        *minmax.first - 1e4f * std::numeric_limits<float>::epsilon();
-    m_span.bmin[1] =
-        *minmax.second + 1e4f * std::numeric_limits<float>::epsilon();
+    m_span.bmin[0] = static_cast<float>(offset + minmax.first) -
+                     1e4f * std::numeric_limits<float>::epsilon();
+    m_span.bmin[1] = static_cast<float>(offset + minmax.second) +
+                     1e4f * std::numeric_limits<float>::epsilon();
   }
 
   if (m_number_of_bins == -1) {
@@ -103,7 +108,8 @@ DataWithAesthetic BinX::operator()(const DataWithAesthetic &data) {
 
   //  accumulate data into histogram
   std::for_each(x_begin, x_end, [&](const float x) {
-    const auto i = static_cast<int>(std::floor((x - m_span.bmin[0]) / dx));
+    const auto i =
+        static_cast<int>(std::floor((offset + x - m_span.bmin[0]) / dx));
     if (i >= 0 && i < m_number_of_bins) {
       ++(bin_y[i]);
     }
@@ -111,7 +117,7 @@ DataWithAesthetic BinX::operator()(const DataWithAesthetic &data) {
 
   // return new data set, making sure to set ymin to zero
   DataWithAesthetic ret;
-  ret.x(m_span.bmin[0], m_span.bmax[0]).y(bin_y);
+  ret.x(m_span.bmin[0], m_span.bmax[0]).y(std::move(bin_y));
   ret.y(0.f, ret.limits().bmax[Aesthetic::y::index]);
   return ret;
 }
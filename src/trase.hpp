@@ -41,7 +41,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "backend/BackendGL.hpp"
 #endif
 
+#include "frontend/Arrow.hpp"
 #include "frontend/Figure.hpp"
+#include "frontend/Npy.hpp"
+#include "util/CSVReader.hpp"
 #ifdef TRASE_HAVE_CURL
 #include "util/CSVDownloader.hpp"
 #endif
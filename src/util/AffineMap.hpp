@@ -0,0 +1,132 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file AffineMap.hpp
+
+#ifndef AFFINEMAP_H_
+#define AFFINEMAP_H_
+
+#include <cstddef>
+
+#include "util/ColumnIterator.hpp"
+#include "util/Simd.hpp"
+
+namespace trase {
+
+/// calculates out[i] = (in[i] - shift) * scale + base for each element of the
+/// contiguous range [begin, end), using the SIMD instructions available (see
+/// Simd.hpp)
+inline void affine_transform(const float *begin, const float *end, float *out,
+                             const float shift, const float scale,
+                             const float base) {
+  const float *i = begin;
+#if defined(TRASE_HAVE_AVX)
+  const __m256 vshift = _mm256_set1_ps(shift);
+  const __m256 vscale = _mm256_set1_ps(scale);
+  const __m256 vbase = _mm256_set1_ps(base);
+  for (; end - i >= 8; i += 8, out += 8) {
+    const __m256 v = _mm256_sub_ps(_mm256_loadu_ps(i), vshift);
+    _mm256_storeu_ps(out, _mm256_add_ps(_mm256_mul_ps(v, vscale), vbase));
+  }
+#elif defined(TRASE_HAVE_SSE2)
+  const __m128 vshift = _mm_set1_ps(shift);
+  const __m128 vscale = _mm_set1_ps(scale);
+  const __m128 vbase = _mm_set1_ps(base);
+  for (; end - i >= 4; i += 4, out += 4) {
+    const __m128 v = _mm_sub_ps(_mm_loadu_ps(i), vshift);
+    _mm_storeu_ps(out, _mm_add_ps(_mm_mul_ps(v, vscale), vbase));
+  }
+#endif
+  // remaining elements (or all of them without SIMD)
+  for (; i != end; ++i, ++out) {
+    *out = (*i - shift) * scale + base;
+  }
+}
+
+/// An affine map from data to display coordinates, display = base + (data -
+/// origin) * scale
+///
+/// The aesthetics (see Aesthetic::x::map()) precompute one of these from the
+/// data limits and display limits, so that mapping each point is a single
+/// subtraction and multiply-add
+class AffineMap {
+  double m_origin{0};
+  float m_scale{1};
+  float m_base{0};
+
+public:
+  AffineMap() = default;
+
+  AffineMap(const double origin, const float scale, const float base)
+      : m_origin(origin), m_scale(scale), m_base(base) {}
+
+  double origin() const { return m_origin; }
+  float scale() const { return m_scale; }
+  float base() const { return m_base; }
+
+  /// map a single (decoded) data value to display coordinates
+  float operator()(const double data) const {
+    return static_cast<float>(m_base + (data - m_origin) * m_scale);
+  }
+
+  /// map every element of the column [begin, end) to display coordinates,
+  /// writing the results to out
+  ///
+  /// the column offset (see ColumnIterator::decode()) is folded into the map,
+  /// contiguous columns are mapped using SIMD instructions and range columns
+  /// are mapped from their decoded values
+  void transform(const ColumnIterator &begin, const ColumnIterator &end,
+                 float *out) const {
+    // (v + offset - origin) * scale + base, computed in float relative to the
+    // offset so that large offsets do not lose precision
+    const auto shift = static_cast<float>(m_origin - begin.offset());
+    if (begin.is_contiguous()) {
+      affine_transform(begin.get(), end.get(), out, shift, m_scale, m_base);
+    } else if (begin.is_range()) {
+      // range elements are calculated in double precision anyway
+      const std::ptrdiff_t n = end - begin;
+      for (std::ptrdiff_t i = 0; i < n; ++i) {
+        out[i] = operator()(begin.decode(i));
+      }
+    } else {
+      const std::ptrdiff_t n = end - begin;
+      for (std::ptrdiff_t i = 0; i < n; ++i) {
+        out[i] = (begin[i] - shift) * m_scale + m_base;
+      }
+    }
+  }
+};
+
+} // namespace trase
+
+#endif // AFFINEMAP_H_
@@ -38,29 +38,98 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <curl/easy.h>
 
 #include <algorithm>
-#include <iostream>
-#include <sstream>
-#include <iterator>
-#include <cctype>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 namespace trase {
-template <typename Out>
-void split(const std::string &s, char delim, Out result) {
-  std::stringstream ss(s);
-  std::string item;
-  while (std::getline(ss, item, delim)) {
-    if (!item.empty()) {
-      *(result++) = item;
-    }
+
+namespace {
+
+/// a download that is parsed as it arrives
+struct Transfer {
+  CSVStream stream;
+
+  /// an exception thrown by the parser, which must not be thrown through
+  /// libcurl
+  std::exception_ptr error;
+};
+
+/// sets the options shared by all downloads on the easy handle @p curl
+void set_options(CURL *curl, const std::string &url) {
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  /* Do not check certificate*/
+  curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+  /* tell libcurl to follow redirection */
+  curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+  curl_easy_setopt(curl, CURLOPT_NOSIGNAL,
+                   1); // Prevent "longjmp causes uninitialized stack frame" bug
+  curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "deflate");
+}
+
+size_t write_data(void *ptr, size_t size, size_t nmemb, void *userdata) {
+  auto &transfer = *static_cast<Transfer *>(userdata);
+  try {
+    transfer.stream.write(static_cast<const char *>(ptr), size * nmemb);
+  } catch (...) {
+    transfer.error = std::current_exception();
   }
+  // returning less than the size given aborts the transfer
+  return transfer.error || transfer.stream.done() ? 0 : size * nmemb;
 }
-size_t write_data(void *ptr, size_t size, size_t nmemb, void *stream) {
-  std::string string_data((const char *)ptr, (size_t)size * nmemb);
-  *((std::stringstream *)stream) << string_data;
+
+size_t append_data(void *ptr, size_t size, size_t nmemb, void *userdata) {
+  static_cast<std::string *>(userdata)->append(static_cast<const char *>(ptr),
+                                               size * nmemb);
   return size * nmemb;
 }
 
-CSVDownloader::CSVDownloader() : m_delim(',') {
+/// joins a set of threads, after calling stop() to tell them to return. This
+/// is done by join() or otherwise on destruction, so the threads are joined
+/// however the scope is left (e.g. by an exception)
+struct JoinThreads {
+  std::vector<std::thread> &threads;
+  std::function<void()> stop;
+
+  void join() {
+    if (stop) {
+      stop();
+      stop = nullptr;
+    }
+    for (auto &thread : threads) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+  }
+
+  ~JoinThreads() { join(); }
+};
+
+/// a libcurl multi handle, which is cleaned up on destruction along with any
+/// easy handles still added to it
+struct MultiHandle {
+  CURLM *multi{curl_multi_init()};
+  std::vector<CURL *> handles;
+
+  ~MultiHandle() {
+    for (CURL *curl : handles) {
+      if (curl) {
+        curl_multi_remove_handle(multi, curl);
+        curl_easy_cleanup(curl);
+      }
+    }
+    curl_multi_cleanup(multi);
+  }
+};
+
+} // namespace
+
+CSVDownloader::CSVDownloader() : m_concurrency(8) {
   m_curl = curl_easy_init();
 }
 
@@ -68,70 +137,179 @@ CSVDownloader::~CSVDownloader() {
   curl_easy_cleanup(m_curl);
 }
 
-CSVDownloader::data_t
-CSVDownloader::parse_csv(std::stringstream &out,
-                         const std::vector<std::string> &labels_in) {
-  CSVDownloader::data_t store;
-  // parse the stringstream as a csv with given delimiter
-  std::string line;
-  std::vector<std::string> labels;
-
-  // if input labels is empty, assume 1st line of data are labels
-  if (labels_in.empty()) {
-    std::getline(out, line);
-    split(line, m_delim, std::back_inserter(labels));
-  } else {
-    labels.resize(labels_in.size());
-    std::copy(labels_in.begin(), labels_in.end(), labels.begin());
+CSVData CSVDownloader::download(const std::string &url,
+                                const std::vector<std::string> &labels) {
+  // use curl to read url, parsing each piece as it arrives
+  set_options(m_curl, url);
+  curl_easy_setopt(m_curl, CURLOPT_WRITEFUNCTION, write_data);
+  Transfer transfer{m_reader.stream(labels), nullptr};
+  curl_easy_setopt(m_curl, CURLOPT_WRITEDATA, &transfer);
+  /* Perform the request, res will get the return code */
+  CURLcode res = curl_easy_perform(m_curl);
+  if (transfer.error) {
+    std::rethrow_exception(transfer.error);
+  }
+  /* Check for errors, other than stopping at the row limit */
+  if (res != CURLE_OK && !transfer.stream.done()) {
+    throw Exception("download of " + url + " failed: " +
+                    curl_easy_strerror(res));
   }
 
-  // parse data
-  while (std::getline(out, line)) {
-    // ignore all whitespace lines
-    if (std::all_of(line.begin(), line.end(),
-                    [](unsigned char c) { return std::isspace(c); })) {
+  return transfer.stream.finish();
+}
+
+std::vector<CSVData>
+CSVDownloader::download_all(const std::vector<std::string> &urls,
+                            const std::vector<std::string> &labels) {
+  // each response is parsed by a single worker, so the workers do not need
+  // more threads
+  CSVReader reader(m_reader);
+  reader.set_threads(1);
+
+  std::vector<std::string> bodies(urls.size());
+  std::vector<CSVData> data(urls.size());
+  std::vector<std::exception_ptr> parse_errors(urls.size());
+
+  // completed responses waiting for a worker, and the number of responses
+  // that are queued or being parsed
+  std::mutex mutex;
+  std::condition_variable queued_cv;
+  std::condition_variable parsed_cv;
+  std::deque<size_t> queue;
+  size_t parsing = 0;
+  bool finished = false;
+
+  auto work = [&]() {
+    while (true) {
+      size_t i;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        queued_cv.wait(lock, [&]() { return finished || !queue.empty(); });
+        if (queue.empty()) {
+          return;
+        }
+        i = queue.front();
+        queue.pop_front();
+      }
+      try {
+        const std::string body = std::move(bodies[i]);
+        data[i] = reader.parse(body.data(), body.data() + body.size(), labels);
+      } catch (...) {
+        parse_errors[i] = std::current_exception();
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        --parsing;
+      }
+      parsed_cv.notify_one();
+    }
+  };
+  const size_t threads = std::min(
+      {m_concurrency, urls.size(),
+       std::max<size_t>(1, std::thread::hardware_concurrency())});
+  auto stop = [&]() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      finished = true;
+    }
+    queued_cv.notify_all();
+  };
+  std::vector<std::thread> workers;
+  JoinThreads join_workers{workers, stop};
+  for (size_t i = 0; i < threads; ++i) {
+    workers.emplace_back(work);
+  }
+
+  MultiHandle transfers;
+  CURLM *multi = transfers.multi;
+  auto &handles = transfers.handles;
+  handles.resize(urls.size(), nullptr);
+  std::string error;
+
+  // keep up to m_concurrency responses in flight, counting those still being
+  // downloaded and those waiting to be parsed, so that the number of
+  // buffered responses is bounded too
+  size_t next = 0;
+  size_t active = 0;
+  auto start_transfers = [&]() {
+    size_t in_flight = active;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      in_flight += parsing;
+    }
+    for (; next < urls.size() && in_flight < m_concurrency;
+         ++next, ++active, ++in_flight) {
+      CURL *curl = curl_easy_init();
+      set_options(curl, urls[next]);
+      curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, append_data);
+      curl_easy_setopt(curl, CURLOPT_WRITEDATA, &bodies[next]);
+      // the index of the url, to find it again when the transfer completes
+      curl_easy_setopt(curl, CURLOPT_PRIVATE,
+                       reinterpret_cast<void *>(static_cast<uintptr_t>(next)));
+      curl_multi_add_handle(multi, curl);
+      handles[next] = curl;
+    }
+  };
+
+  while (next < urls.size() || active > 0) {
+    start_transfers();
+    if (active == 0) {
+      // every slot holds a response being parsed, wait for one of them
+      std::unique_lock<std::mutex> lock(mutex);
+      parsed_cv.wait(lock, [&]() { return parsing < m_concurrency; });
       continue;
     }
 
-    // split up line according to delimiter
-    std::vector<std::string> elems;
-    split(line, m_delim, std::back_inserter(elems));
-    if (elems.size() != labels.size()) {
-      throw Exception("CSVDownloader found differing line lengths");
+    int running;
+    curl_multi_perform(multi, &running);
+
+    // queue each completed response for the workers
+    int queued;
+    while (CURLMsg *message = curl_multi_info_read(multi, &queued)) {
+      if (message->msg != CURLMSG_DONE) {
+        continue;
+      }
+      CURL *curl = message->easy_handle;
+      const CURLcode res = message->data.result;
+      char *index;
+      curl_easy_getinfo(curl, CURLINFO_PRIVATE, &index);
+      const auto i = static_cast<size_t>(reinterpret_cast<uintptr_t>(index));
+      curl_multi_remove_handle(multi, curl);
+      curl_easy_cleanup(curl);
+      handles[i] = nullptr;
+      --active;
+
+      if (res != CURLE_OK) {
+        if (error.empty()) {
+          error = "download of " + urls[i] + " failed: " +
+                  curl_easy_strerror(res);
+        }
+        bodies[i] = std::string();
+      } else {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          ++parsing;
+          queue.push_back(i);
+        }
+        queued_cv.notify_one();
+      }
     }
 
-    // store individual elements from this line
-    for (size_t i = 0; i < labels.size(); ++i) {
-      store[labels[i]].push_back(elems[i]);
+    if (active > 0) {
+      curl_multi_wait(multi, nullptr, 0, 100, nullptr);
     }
   }
-  return store;
-}
+  join_workers.join();
 
-CSVDownloader::data_t
-CSVDownloader::download(const std::string &url,
-                        const std::vector<std::string> &labels) {
-  // use curl to read url to a stringstream
-  curl_easy_setopt(m_curl, CURLOPT_URL, url.c_str());
-  /* Do not check certificate*/
-  curl_easy_setopt(m_curl, CURLOPT_SSL_VERIFYPEER, 0L);
-  /* tell libcurl to follow redirection */
-  curl_easy_setopt(m_curl, CURLOPT_FOLLOWLOCATION, 1L);
-  curl_easy_setopt(m_curl, CURLOPT_NOSIGNAL,
-                   1); // Prevent "longjmp causes uninitialized stack frame" bug
-  curl_easy_setopt(m_curl, CURLOPT_ACCEPT_ENCODING, "deflate");
-  curl_easy_setopt(m_curl, CURLOPT_WRITEFUNCTION, write_data);
-  std::stringstream out;
-  curl_easy_setopt(m_curl, CURLOPT_WRITEDATA, &out);
-  /* Perform the request, res will get the return code */
-  CURLcode res = curl_easy_perform(m_curl);
-  /* Check for errors */
-  if (res != CURLE_OK) {
-    fprintf(stderr, "curl_easy_perform() failed: %s\n",
-            curl_easy_strerror(res));
+  if (!error.empty()) {
+    throw Exception(error);
   }
-
-  return parse_csv(out, labels);
+  for (const auto &parse_error : parse_errors) {
+    if (parse_error) {
+      std::rethrow_exception(parse_error);
+    }
+  }
+  return data;
 }
 
 } // namespace trase
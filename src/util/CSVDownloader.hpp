@@ -36,18 +36,18 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef _CSVDownloader_H_
 #define _CSVDownloader_H_
 
-#include <map>
+#include <algorithm>
+#include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "util/CSVReader.hpp"
+
 namespace trase {
 
 class CSVDownloader {
 public:
-  /// columns of csv file returned as a map from string label to a column of
-  /// data (vector of strings)
-  using data_t = std::map<std::string, std::vector<std::string>>;
-
   /// constructs a csv downloader with default delimiter of ','
   CSVDownloader();
 
@@ -59,22 +59,66 @@ public:
   /// @param labels if empty, the first line of the csv file is assumed to
   /// contain the column labels If not empty, this vector contains the column
   /// labels
-  data_t download(const std::string &url,
-                  const std::vector<std::string> &labels = {});
+  ///
+  /// The columns are typed and parsed as for CSVReader, i.e. numeric columns
+  /// are float columns and other columns are dictionary encoded strings.
+  /// Throws trase::Exception if the transfer fails or the file cannot be
+  /// parsed
+  CSVData download(const std::string &url,
+                   const std::vector<std::string> &labels = {});
+
+  /// download the csv files at each of @p urls, see download()
+  ///
+  /// Up to set_concurrency() files are downloaded at once, using the libcurl
+  /// multi interface. Each response is buffered, and parsed by a pool of at
+  /// most set_concurrency() worker threads (and no more than the hardware
+  /// threads) as soon as it is complete while the other transfers continue.
+  /// Responses waiting to be parsed count towards the concurrency, so at
+  /// most set_concurrency() responses are buffered at once. As the whole
+  /// response is parsed at once, a row limit (see set_max_rows()) does not
+  /// stop a transfer early
+  ///
+  /// Returns the columns of each file, in the order of @p urls. Throws
+  /// trase::Exception if a transfer fails, once the others are complete
+  std::vector<CSVData>
+  download_all(const std::vector<std::string> &urls,
+               const std::vector<std::string> &labels = {});
+
+  /// set the maximum number of files that download_all() downloads or
+  /// parses at once (8 by default)
+  void set_concurrency(const size_t concurrency) {
+    m_concurrency = std::max<size_t>(1, concurrency);
+  }
 
   /// set the delimiter for the csv file format
-  void set_delim(const char arg) { m_delim = arg; }
+  void set_delim(const char arg) { m_reader.set_delim(arg); }
 
-private:
-  /// parse a csv file given as a `std::stringstream`
-  CSVDownloader::data_t parse_csv(std::stringstream &out,
-                                  const std::vector<std::string> &labels);
+  /// only download the columns labelled @p columns, see
+  /// CSVReader::set_columns()
+  void set_columns(std::vector<std::string> columns) {
+    m_reader.set_columns(std::move(columns));
+  }
+
+  /// only keep the lines for which @p filter returns true, see
+  /// CSVReader::set_filter()
+  void set_filter(std::function<bool(const CSVRow &)> filter) {
+    m_reader.set_filter(std::move(filter));
+  }
+
+  /// stop after @p rows rows, see CSVReader::set_max_rows(). The transfer is
+  /// aborted once the limit is reached, so the rest of the file is not
+  /// downloaded
+  void set_max_rows(const size_t rows) { m_reader.set_max_rows(rows); }
 
+private:
   /// pointer to libcurl data
   void *m_curl;
 
-  /// delimiter for the csv file format
-  char m_delim;
+  /// the csv format and the columns and rows to read
+  CSVReader m_reader;
+
+  /// the maximum number of concurrent transfers of download_all()
+  size_t m_concurrency;
 };
 
 } // namespace trase
@@ -0,0 +1,940 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "util/CSVReader.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "util/Exception.hpp"
+#include "util/MappedFile.hpp"
+#include "util/Simd.hpp"
+
+namespace trase {
+
+namespace {
+
+/// files are split into chunks of at least this many bytes for parsing, so
+/// that small files are not spread over threads
+constexpr size_t min_chunk_size = 1 << 16;
+
+/// a field of a line, as a range of the csv buffer
+using field_t = CSVRow::field_t;
+
+#ifdef TRASE_HAVE_SSE2
+/// returns the index of the lowest set bit of @p mask, which must not be 0
+inline int first_bit(const unsigned int mask) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+/// returns the number of set bits of @p mask
+inline size_t count_bits(unsigned int mask) {
+#ifdef _MSC_VER
+  size_t n = 0;
+  for (; mask != 0; mask &= mask - 1) {
+    ++n;
+  }
+  return n;
+#else
+  return static_cast<size_t>(__builtin_popcount(mask));
+#endif
+}
+#endif
+
+/// returns the first @p delim or newline in [@p p, @p end), or @p end if
+/// there is none
+const char *find_field_end(const char *p, const char *end, const char delim) {
+#ifdef TRASE_HAVE_SSE2
+  const __m128i delims = _mm_set1_epi8(delim);
+  const __m128i newlines = _mm_set1_epi8('\n');
+  for (; end - p >= 16; p += 16) {
+    const __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    const int mask = _mm_movemask_epi8(_mm_or_si128(
+        _mm_cmpeq_epi8(bytes, delims), _mm_cmpeq_epi8(bytes, newlines)));
+    if (mask != 0) {
+      return p + first_bit(static_cast<unsigned int>(mask));
+    }
+  }
+#endif
+  while (p != end && *p != delim && *p != '\n') {
+    ++p;
+  }
+  return p;
+}
+
+/// returns the start of the line after the one containing @p p, or @p end
+const char *next_line(const char *p, const char *end) {
+  const auto newline =
+      static_cast<const char *>(std::memchr(p, '\n', end - p));
+  return newline ? newline + 1 : end;
+}
+
+/// returns the start of the line after the one containing @p p, or @p end,
+/// and adds the number of @p delim in the rest of the line to @p delims
+const char *skip_line(const char *p, const char *end, const char delim,
+                      size_t &delims) {
+#ifdef TRASE_HAVE_SSE2
+  const __m128i delim_bytes = _mm_set1_epi8(delim);
+  const __m128i newlines = _mm_set1_epi8('\n');
+  for (; end - p >= 16; p += 16) {
+    const __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    const auto delim_mask = static_cast<unsigned int>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, delim_bytes)));
+    const auto newline_mask = static_cast<unsigned int>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newlines)));
+    if (newline_mask != 0) {
+      const int newline = first_bit(newline_mask);
+      delims += count_bits(delim_mask & ((1u << newline) - 1));
+      return p + newline + 1;
+    }
+    delims += count_bits(delim_mask);
+  }
+#endif
+  for (; p != end; ++p) {
+    if (*p == '\n') {
+      return p + 1;
+    }
+    delims += *p == delim;
+  }
+  return end;
+}
+
+/// returns true if [@p begin, @p end) only contains whitespace
+bool is_blank(const char *begin, const char *end) {
+  return std::all_of(begin, end,
+                     [](unsigned char c) { return std::isspace(c); });
+}
+
+/// splits the line starting at @p p into @p fields, and returns the start of
+/// the next line. Only the first @p max_fields fields are split, the rest of
+/// the line is skipped and the number of fields in it is stored in
+/// @p skipped (if given)
+const char *
+split_line(const char *p, const char *end, const char delim,
+           std::vector<field_t> &fields,
+           const size_t max_fields = std::numeric_limits<size_t>::max(),
+           size_t *skipped = nullptr) {
+  fields.clear();
+  if (skipped) {
+    *skipped = 0;
+  }
+  while (true) {
+    const char *field_end = find_field_end(p, end, delim);
+    fields.emplace_back(p, field_end);
+    if (field_end == end || *field_end == '\n') {
+      // strip the carriage return of a windows line ending
+      auto &last = fields.back();
+      if (last.second != last.first && last.second[-1] == '\r') {
+        --last.second;
+      }
+      return field_end == end ? end : field_end + 1;
+    }
+    if (fields.size() == max_fields) {
+      if (!skipped) {
+        return next_line(field_end, end);
+      }
+      *skipped = 1;
+      return skip_line(field_end + 1, end, delim, *skipped);
+    }
+    p = field_end + 1;
+  }
+}
+
+/// the format of the lines of a csv file, and which of their fields are read
+/// (see CSVReader::set_columns() and CSVReader::set_filter())
+struct LineFormat {
+  char delim;
+
+  /// the label of each field of a line
+  std::vector<std::string> labels;
+
+  /// the field of each column that is read
+  std::vector<size_t> fields;
+
+  /// the number of fields of a line that are split, which is all of them
+  /// unless the fields after the last column read are not needed
+  size_t split;
+
+  /// lines for which this returns false are skipped, if set
+  std::function<bool(const CSVRow &)> filter;
+
+  LineFormat() = default;
+
+  LineFormat(const char delim, std::vector<std::string> labels,
+             const std::vector<std::string> &columns,
+             std::function<bool(const CSVRow &)> filter)
+      : delim(delim), labels(std::move(labels)), filter(std::move(filter)) {
+    for (size_t i = 0; columns.empty() && i < this->labels.size(); ++i) {
+      fields.push_back(i);
+    }
+    for (const auto &column : columns) {
+      auto i = std::find(this->labels.begin(), this->labels.end(), column);
+      if (i == this->labels.end()) {
+        throw Exception("no column called " + column);
+      }
+      fields.push_back(static_cast<size_t>(i - this->labels.begin()));
+    }
+    split = this->labels.size();
+    if (!this->filter && !fields.empty()) {
+      split = *std::max_element(fields.begin(), fields.end()) + 1;
+    }
+  }
+
+  /// returns the labels of the columns that are read
+  std::vector<std::string> names() const {
+    std::vector<std::string> names;
+    for (const size_t i : fields) {
+      names.push_back(labels[i]);
+    }
+    return names;
+  }
+};
+
+/// calls @p f with the start and the fields of each line in [@p begin,
+/// @p end), skipping lines that only contain whitespace or are rejected by
+/// the filter of @p format, until @p f has been called for @p max_rows lines.
+/// Returns the start of the line after the last line passed to @p f (or
+/// @p end)
+template <typename Function>
+const char *for_each_line(const char *begin, const char *end,
+                          const LineFormat &format, const size_t max_rows,
+                          Function f) {
+  const size_t cols = format.labels.size();
+  std::vector<field_t> fields;
+  size_t skipped;
+  const char *p = begin;
+  for (size_t rows = 0; p != end && rows < max_rows;) {
+    const char *line = p;
+    p = split_line(p, end, format.delim, fields, format.split, &skipped);
+
+    // ignore all whitespace lines
+    if (std::isspace(static_cast<unsigned char>(*line)) && is_blank(line, p)) {
+      continue;
+    }
+
+    if (fields.size() + skipped != cols) {
+      throw Exception("CSVReader found differing line lengths");
+    }
+    if (format.filter && !format.filter(CSVRow(format.labels, fields))) {
+      continue;
+    }
+    f(line, fields);
+    ++rows;
+  }
+  return p;
+}
+
+/// calls @p f(i) for each i in [0, @p n) using up to @p threads threads, and
+/// rethrows the first exception thrown by @p f
+template <typename Function>
+void parallel_for(const size_t n, const size_t threads, Function f) {
+  std::atomic<size_t> next{0};
+  std::vector<std::exception_ptr> errors(n);
+  auto work = [&]() {
+    for (size_t i = next++; i < n; i = next++) {
+      try {
+        f(i);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < std::min(n, threads); ++i) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  for (const auto &error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+/// the powers of ten that are exactly representable as a double
+constexpr double powers_of_ten[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                    1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                    1e18, 1e19, 1e20, 1e21, 1e22};
+
+/// parses the decimal number in [@p begin, @p end) into @p value, ignoring
+/// surrounding spaces. An empty field is NaN. Returns false if the field is
+/// not a number
+///
+/// Numbers with at most 15 significant digits and a small exponent (i.e.
+/// nearly all of them) are converted exactly from an integer mantissa and a
+/// power of ten, all others are passed to std::strtod
+bool parse_number(const char *begin, const char *end, double &value) {
+  while (begin != end && *begin == ' ') {
+    ++begin;
+  }
+  while (end != begin && end[-1] == ' ') {
+    --end;
+  }
+  if (begin == end) {
+    value = std::numeric_limits<double>::quiet_NaN();
+    return true;
+  }
+
+  const char *p = begin;
+  const bool negative = *p == '-';
+  if (*p == '-' || *p == '+') {
+    ++p;
+  }
+  uint64_t mantissa = 0;
+  int exponent = 0;
+  bool digits = false;
+  auto add_digit = [&](const char c) {
+    digits = true;
+    if (mantissa < (std::numeric_limits<uint64_t>::max() - 9) / 10) {
+      mantissa = 10 * mantissa + static_cast<uint64_t>(c - '0');
+      return true;
+    }
+    return false;
+  };
+  for (; p != end && std::isdigit(static_cast<unsigned char>(*p)); ++p) {
+    exponent += !add_digit(*p);
+  }
+  if (p != end && *p == '.') {
+    for (++p; p != end && std::isdigit(static_cast<unsigned char>(*p)); ++p) {
+      exponent -= add_digit(*p);
+    }
+  }
+  if (!digits) {
+    return false;
+  }
+  if (p != end && (*p == 'e' || *p == 'E')) {
+    ++p;
+    const bool negative_exponent = p != end && *p == '-';
+    if (p != end && (*p == '-' || *p == '+')) {
+      ++p;
+    }
+    if (p == end) {
+      return false;
+    }
+    int e = 0;
+    for (; p != end && std::isdigit(static_cast<unsigned char>(*p)); ++p) {
+      e = std::min(10 * e + (*p - '0'), 100000);
+    }
+    exponent += negative_exponent ? -e : e;
+  }
+  if (p != end) {
+    return false;
+  }
+
+  if (mantissa < (uint64_t(1) << 53) && std::abs(exponent) <= 22) {
+    const auto m = static_cast<double>(mantissa);
+    value = exponent < 0 ? m / powers_of_ten[-exponent]
+                         : m * powers_of_ten[exponent];
+    value = negative ? -value : value;
+  } else {
+    value = std::strtod(std::string(begin, end).c_str(), nullptr);
+  }
+  return true;
+}
+
+/// the fields of one column in one chunk of a csv file
+struct ChunkColumn {
+  /// true while every field is a number
+  bool numeric{true};
+
+  /// the first finite number, which the numbers are relative to
+  double offset{std::numeric_limits<double>::quiet_NaN()};
+
+  /// true if the text of numeric fields that write_number() cannot write
+  /// again is also encoded (into index and texts), for when the lines cannot
+  /// be scanned again by to_strings()
+  bool keep_text{false};
+
+  /// the numbers minus offset, if numeric
+  std::vector<float> numbers;
+
+  /// the index of each distinct field, if not numeric or keep_text
+  std::unordered_map<std::string, uint32_t> index;
+
+  /// the index of each field, if not numeric
+  std::vector<uint32_t> codes;
+
+  /// the row and index of each field kept as text, if numeric and keep_text
+  std::vector<std::pair<size_t, uint32_t>> texts;
+
+  void add_number(const double value) {
+    if (std::isnan(offset) && std::isfinite(value)) {
+      offset = value;
+    }
+    numbers.push_back(
+        static_cast<float>(std::isnan(offset) ? value : value - offset));
+  }
+
+  /// returns the index of @p string, adding it if it is new
+  uint32_t encode(const std::string &string) {
+    auto i = index.find(string);
+    if (i == index.end()) {
+      i = index.emplace(string, static_cast<uint32_t>(index.size())).first;
+    }
+    return i->second;
+  }
+
+  void add_string(const std::string &string) {
+    codes.push_back(encode(string));
+  }
+
+  /// adds the field @p field, using @p key as a buffer to look it up
+  void add_string(const field_t &field, std::string &key) {
+    key.assign(field.first, field.second);
+    add_string(key);
+  }
+
+  /// keeps the text of the last number added, @p value parsed from the field
+  /// @p field, unless write_number() writes it again. Uses @p key as a buffer
+  void keep_text_of(const field_t &field, const double value,
+                    std::string &key) {
+    if (!is_written(field.first, field.second, value, numbers.back())) {
+      key.assign(field.first, field.second);
+      texts.emplace_back(numbers.size() - 1, encode(key));
+    }
+  }
+
+  /// returns true if write_number() writes @p number, which is @p value
+  /// parsed from [@p begin, @p end), as that text. This is the case for
+  /// plain decimals of up to 15 digits without redundant zeros (e.g. not
+  /// "007", "1.50" or "1e3") when @p number is precise to the last digit
+  bool is_written(const char *begin, const char *end, const double value,
+                  const float number) const {
+    if (begin == end) {
+      return true;
+    }
+    const char *p = begin;
+    if (*p == '-') {
+      if (value == 0) {
+        return false;
+      }
+      ++p;
+    }
+    const char *digits = p;
+    while (p != end && std::isdigit(static_cast<unsigned char>(*p))) {
+      ++p;
+    }
+    if (p == digits || (*digits == '0' && p - digits > 1)) {
+      return false;
+    }
+    ptrdiff_t decimals = 0;
+    if (p != end && *p == '.') {
+      const char *first = ++p;
+      while (p != end && std::isdigit(static_cast<unsigned char>(*p))) {
+        ++p;
+      }
+      decimals = p - first;
+      if (decimals == 0 || p[-1] == '0') {
+        return false;
+      }
+    }
+    if (p != end || p - digits - (decimals > 0) > 15) {
+      return false;
+    }
+    // a number differing by a unit of the last digit is another float, and
+    // the number is within a quarter unit, so its text has to be this one
+    const double unit = 1 / powers_of_ten[decimals];
+    const float magnitude = std::abs(number);
+    const float ulp =
+        std::nextafter(magnitude, std::numeric_limits<float>::infinity()) -
+        magnitude;
+    return 4.0 * ulp <= unit && std::abs(offset + number - value) < unit / 4;
+  }
+
+  /// returns the text of number @p i, i.e. the fewest decimals that are
+  /// parsed into the same number
+  std::string write_number(const size_t i) const {
+    const float number = numbers[i];
+    if (std::isnan(number)) {
+      return std::string();
+    }
+    const double value = offset + number;
+    char buffer[64];
+    for (int decimals = 0; decimals <= 15; ++decimals) {
+      std::snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+      if (static_cast<float>(std::strtod(buffer, nullptr) - offset) ==
+          number) {
+        break;
+      }
+    }
+    return buffer;
+  }
+
+  /// returns the number of rows of the column
+  size_t size() const { return numeric ? numbers.size() : codes.size(); }
+
+  /// changes the column to strings, by encoding column @p i of the lines in
+  /// [@p begin, @p end) (the lines already parsed as numbers)
+  void to_strings(const char *begin, const char *end, const LineFormat &format,
+                  const size_t i) {
+    numeric = false;
+    numbers = std::vector<float>();
+    std::string key;
+    const size_t field = format.fields[i];
+    for_each_line(begin, end, format, std::numeric_limits<size_t>::max(),
+                  [&](const char *, const std::vector<field_t> &fields) {
+                    add_string(fields[field], key);
+                  });
+  }
+
+  /// changes the column to strings using the text kept for the numbers
+  /// parsed so far (see keep_text), writing the others with write_number()
+  void text_to_strings() {
+    codes.reserve(numbers.size());
+    auto text = texts.begin();
+    for (size_t row = 0; row < numbers.size(); ++row) {
+      if (text != texts.end() && text->first == row) {
+        codes.push_back((text++)->second);
+      } else {
+        add_string(write_number(row));
+      }
+    }
+    numeric = false;
+    numbers = std::vector<float>();
+    texts = std::vector<std::pair<size_t, uint32_t>>();
+  }
+};
+
+/// parses up to @p max_rows lines in [@p begin, @p end) into @p columns (see
+/// for_each_line()), as numbers unless a column has a field that is not a
+/// number. The column is then changed to strings by calling @p to_strings
+/// with the column index and the start of the line. Returns the start of the
+/// line after the last line parsed
+template <typename ToStrings>
+const char *parse_lines(const char *begin, const char *end,
+                        const LineFormat &format, const size_t max_rows,
+                        std::vector<ChunkColumn> &columns,
+                        ToStrings to_strings) {
+  std::string key;
+  return for_each_line(
+      begin, end, format, max_rows,
+      [&](const char *line, const std::vector<field_t> &fields) {
+        for (size_t i = 0; i < columns.size(); ++i) {
+          auto &column = columns[i];
+          const auto &field = fields[format.fields[i]];
+          double value;
+          if (column.numeric) {
+            if (parse_number(field.first, field.second, value)) {
+              column.add_number(value);
+              if (column.keep_text) {
+                column.keep_text_of(field, value, key);
+              }
+              continue;
+            }
+            to_strings(i, line);
+          }
+          column.add_string(field, key);
+        }
+      });
+}
+
+/// a range of lines of a csv file, and their fields
+struct Chunk {
+  const char *begin;
+  const char *end;
+  std::vector<ChunkColumn> columns;
+
+  /// parses up to @p max_rows lines of the chunk. The end of the chunk is
+  /// moved to the last line parsed
+  void parse(const LineFormat &format, const size_t max_rows) {
+    end = parse_lines(begin, end, format, max_rows, columns,
+                      [&](const size_t i, const char *line) {
+                        columns[i].to_strings(begin, line, format, i);
+                      });
+  }
+};
+
+/// concatenates column @p i of @p chunks as a float column
+Column merge_numbers(std::vector<Chunk> &chunks, const size_t i) {
+  double offset = 0.0;
+  size_t rows = 0;
+  for (auto chunk = chunks.rbegin(); chunk != chunks.rend(); ++chunk) {
+    const auto &column = chunk->columns[i];
+    rows += column.numbers.size();
+    if (!std::isnan(column.offset)) {
+      offset = column.offset;
+    }
+  }
+  std::vector<float> values;
+  values.reserve(rows);
+  for (auto &chunk : chunks) {
+    auto &column = chunk.columns[i];
+    const double shift =
+        std::isnan(column.offset) ? 0.0 : column.offset - offset;
+    if (shift == 0.0) {
+      values.insert(values.end(), column.numbers.begin(),
+                    column.numbers.end());
+    } else {
+      for (const float number : column.numbers) {
+        values.push_back(static_cast<float>(shift + number));
+      }
+    }
+    column.numbers = std::vector<float>();
+  }
+  return Column(std::move(values), offset);
+}
+
+/// concatenates column @p i of @p chunks as a column of indices into the
+/// sorted @p dictionary
+Column merge_strings(std::vector<Chunk> &chunks, const size_t i,
+                     std::vector<std::string> &dictionary) {
+  size_t rows = 0;
+  for (const auto &chunk : chunks) {
+    const auto &column = chunk.columns[i];
+    rows += column.codes.size();
+    for (const auto &word : column.index) {
+      dictionary.push_back(word.first);
+    }
+  }
+  std::sort(dictionary.begin(), dictionary.end());
+  dictionary.erase(std::unique(dictionary.begin(), dictionary.end()),
+                   dictionary.end());
+
+  std::vector<float> values;
+  values.reserve(rows);
+  std::vector<float> codes;
+  for (auto &chunk : chunks) {
+    auto &column = chunk.columns[i];
+    codes.resize(column.index.size());
+    for (const auto &word : column.index) {
+      codes[word.second] = static_cast<float>(
+          std::lower_bound(dictionary.begin(), dictionary.end(), word.first) -
+          dictionary.begin());
+    }
+    for (const uint32_t code : column.codes) {
+      values.push_back(codes[code]);
+    }
+    column = ChunkColumn();
+  }
+  return Column(std::move(values));
+}
+
+/// concatenates the columns of @p chunks, which are numeric if @p numeric is
+/// true for the column (and every chunk parsed it as numbers)
+std::shared_ptr<RawData> merge(std::vector<Chunk> &chunks,
+                               const std::vector<bool> &numeric,
+                               const size_t threads) {
+  const size_t cols = numeric.size();
+  std::vector<Column> columns(cols);
+  std::vector<std::vector<std::string>> dictionaries(cols);
+  parallel_for(cols, threads, [&](const size_t i) {
+    columns[i] = numeric[i] ? merge_numbers(chunks, i)
+                            : merge_strings(chunks, i, dictionaries[i]);
+  });
+
+  auto data = std::make_shared<RawData>();
+  data->reserve(cols);
+  for (size_t i = 0; i < cols; ++i) {
+    if (numeric[i]) {
+      data->add_column(std::move(columns[i]));
+    } else {
+      data->add_column(std::move(columns[i]), std::move(dictionaries[i]));
+    }
+  }
+  return data;
+}
+
+} // namespace
+
+size_t CSVRow::index(const std::string &label) const {
+  auto i = std::find(m_labels.begin(), m_labels.end(), label);
+  if (i == m_labels.end()) {
+    throw Exception("no column called " + label);
+  }
+  return static_cast<size_t>(i - m_labels.begin());
+}
+
+const CSVRow::field_t &CSVRow::field(const size_t i) const {
+  if (i >= m_fields.size()) {
+    throw std::out_of_range("column index out of range");
+  }
+  return m_fields[i];
+}
+
+std::string CSVRow::string(const std::string &label) const {
+  return string(index(label));
+}
+
+std::string CSVRow::string(const size_t i) const {
+  const auto &f = field(i);
+  return std::string(f.first, f.second);
+}
+
+double CSVRow::number(const std::string &label) const {
+  return number(index(label));
+}
+
+double CSVRow::number(const size_t i) const {
+  const auto &f = field(i);
+  double value;
+  return parse_number(f.first, f.second, value)
+             ? value
+             : std::numeric_limits<double>::quiet_NaN();
+}
+
+size_t CSVData::column(const std::string &name) const {
+  auto i = std::find(names.begin(), names.end(), name);
+  if (i == names.end()) {
+    throw Exception("no column called " + name);
+  }
+  return static_cast<size_t>(i - names.begin());
+}
+
+CSVReader::CSVReader() : m_delim(','), m_threads(0), m_max_rows(0) {}
+
+CSVData CSVReader::read(const std::string &filename,
+                        const std::vector<std::string> &labels) const {
+  MappedFile file(filename);
+  return parse(file.data(), file.data() + file.size(), labels);
+}
+
+CSVStream CSVReader::stream(const std::vector<std::string> &labels) const {
+  return CSVStream(*this, labels);
+}
+
+CSVData CSVReader::parse(const char *begin, const char *end,
+                         const std::vector<std::string> &labels_in) const {
+  // if input labels is empty, assume 1st line of data are labels
+  std::vector<std::string> labels(labels_in);
+  if (labels.empty()) {
+    std::vector<field_t> fields;
+    begin = split_line(begin, end, m_delim, fields);
+    for (const auto &field : fields) {
+      labels.emplace_back(field.first, field.second);
+    }
+  }
+  const LineFormat format(m_delim, std::move(labels), m_columns, m_filter);
+  const size_t cols = format.fields.size();
+
+  // split the data at line boundaries into one chunk per thread. With a row
+  // limit a single chunk is parsed up to the limit instead
+  const size_t size = static_cast<size_t>(end - begin);
+  const size_t threads =
+      m_threads ? m_threads
+                : std::max<size_t>(1, std::thread::hardware_concurrency());
+  const size_t n =
+      m_max_rows
+          ? 1
+          : std::max<size_t>(1, std::min(threads, size / min_chunk_size));
+  const size_t max_rows =
+      m_max_rows ? m_max_rows : std::numeric_limits<size_t>::max();
+  std::vector<Chunk> chunks(n, Chunk{begin, end, {}});
+  for (size_t i = 1; i < n; ++i) {
+    chunks[i].begin = std::max(chunks[i - 1].begin,
+                               next_line(begin + i * (size / n), end));
+    chunks[i - 1].end = chunks[i].begin;
+  }
+  for (auto &chunk : chunks) {
+    chunk.columns.resize(cols);
+  }
+
+  parallel_for(n, threads,
+               [&](const size_t i) { chunks[i].parse(format, max_rows); });
+
+  // a column is only numeric if it is numeric in every chunk, so convert the
+  // chunks that parsed a string column as numbers
+  std::vector<bool> numeric(cols, true);
+  for (size_t i = 0; i < cols; ++i) {
+    for (const auto &chunk : chunks) {
+      numeric[i] = numeric[i] && chunk.columns[i].numeric;
+    }
+  }
+  parallel_for(n, threads, [&](const size_t i) {
+    auto &chunk = chunks[i];
+    for (size_t j = 0; j < cols; ++j) {
+      if (!numeric[j] && chunk.columns[j].numeric) {
+        chunk.columns[j].to_strings(chunk.begin, chunk.end, format, j);
+      }
+    }
+  });
+
+  CSVData result;
+  result.names = format.names();
+  result.data = merge(chunks, numeric, threads);
+  return result;
+}
+
+/// the state of a CSVStream
+struct CSVStreamState {
+  /// the settings of the stream
+  CSVReader reader;
+
+  /// the format of the lines, once the labels are known
+  LineFormat format;
+  bool has_format{false};
+
+  /// the columns parsed so far
+  Chunk chunk{nullptr, nullptr, {}};
+
+  explicit CSVStreamState(const CSVReader &reader) : reader(reader) {}
+
+  char delim() const { return reader.m_delim; }
+
+  void set_labels(std::vector<std::string> labels) {
+    format = LineFormat(reader.m_delim, std::move(labels), reader.m_columns,
+                        reader.m_filter);
+    chunk.columns.resize(format.fields.size());
+    // the lines written so far are gone by the time a column turns out not
+    // to be numeric, so keep the text of the numbers it cannot write again
+    for (auto &column : chunk.columns) {
+      column.keep_text = true;
+    }
+    has_format = true;
+  }
+
+  /// returns the number of rows parsed so far
+  size_t rows() const {
+    return chunk.columns.empty() ? 0 : chunk.columns[0].size();
+  }
+
+  /// returns the number of rows that are still to be parsed
+  size_t remaining_rows() const {
+    return reader.m_max_rows ? reader.m_max_rows - rows()
+                             : std::numeric_limits<size_t>::max();
+  }
+};
+
+CSVStream::CSVStream(const CSVReader &reader, std::vector<std::string> labels)
+    : m_state(new CSVStreamState(reader)) {
+  if (!labels.empty()) {
+    m_state->set_labels(std::move(labels));
+  }
+}
+
+CSVStream::CSVStream(CSVStream &&other) = default;
+CSVStream &CSVStream::operator=(CSVStream &&other) = default;
+CSVStream::~CSVStream() = default;
+
+void CSVStream::write(const char *data, const size_t size) {
+  if (done()) {
+    return;
+  }
+  const char *end = data + size;
+  const char *newline =
+      static_cast<const char *>(std::memchr(data, '\n', size));
+  if (!newline) {
+    m_partial.append(data, size);
+    return;
+  }
+
+  // complete the line continued from the last write
+  if (!m_partial.empty()) {
+    m_partial.append(data, newline + 1);
+    parse(m_partial.data(), m_partial.data() + m_partial.size());
+    data = newline + 1;
+  }
+
+  // parse the complete lines in place, and keep the rest for the next write
+  const char *last = end;
+  while (last != data && last[-1] != '\n') {
+    --last;
+  }
+  parse(data, last);
+  m_partial.assign(last, end);
+}
+
+bool CSVStream::done() const {
+  return m_state->has_format && m_state->remaining_rows() == 0;
+}
+
+CSVData CSVStream::finish() {
+  parse(m_partial.data(), m_partial.data() + m_partial.size());
+  m_partial.clear();
+
+  CSVData result;
+  if (!m_state->has_format) {
+    result.data = std::make_shared<RawData>();
+    return result;
+  }
+  auto &state = *m_state;
+  std::vector<bool> numeric(state.chunk.columns.size());
+  for (size_t i = 0; i < numeric.size(); ++i) {
+    numeric[i] = state.chunk.columns[i].numeric;
+  }
+  std::vector<Chunk> chunks(1, Chunk{nullptr, nullptr, {}});
+  std::swap(chunks[0].columns, state.chunk.columns);
+  state.chunk.columns.resize(numeric.size());
+
+  result.names = state.format.names();
+  result.data = merge(chunks, numeric, 1);
+  return result;
+}
+
+void CSVStream::parse(const char *begin, const char *end) {
+  auto &state = *m_state;
+  if (done()) {
+    return;
+  }
+
+  // if no labels were given, the first line contains the labels
+  if (begin != end && !state.has_format) {
+    std::vector<field_t> fields;
+    begin = split_line(begin, end, state.delim(), fields);
+    std::vector<std::string> labels;
+    for (const auto &field : fields) {
+      labels.emplace_back(field.first, field.second);
+    }
+    state.set_labels(std::move(labels));
+  }
+  auto &columns = state.chunk.columns;
+  parse_lines(begin, end, state.format, state.remaining_rows(), columns,
+              [&](const size_t i, const char *) {
+                columns[i].text_to_strings();
+              });
+}
+
+} // namespace trase
@@ -0,0 +1,253 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file CSVReader.hpp
+
+#ifndef CSV_READER_H_
+#define CSV_READER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "frontend/Data.hpp"
+
+namespace trase {
+
+/// The typed columns of a csv file, see CSVReader
+struct CSVData {
+  /// one column for each field of the csv file. Columns in which every field
+  /// is a number (or empty, which gives NaN) are float columns, offset
+  /// encoded (see Column) relative to their first number. All other columns
+  /// are dictionary encoded strings, see RawData::string_data()
+  std::shared_ptr<RawData> data;
+
+  /// the label of each column of data
+  std::vector<std::string> names;
+
+  /// returns the index of the column called @p name, which can be passed to
+  /// DataWithAesthetic::bind() to map the column to an aesthetic. Throws
+  /// trase::Exception if there is no such column
+  size_t column(const std::string &name) const;
+};
+
+/// A line of a csv file, as passed to the row filter of a CSVReader (see
+/// CSVReader::set_filter())
+class CSVRow {
+public:
+  /// a field of the line, as a range of the csv buffer
+  using field_t = std::pair<const char *, const char *>;
+
+  CSVRow(const std::vector<std::string> &labels,
+         const std::vector<field_t> &fields)
+      : m_labels(labels), m_fields(fields) {}
+
+  /// returns the index of the column labelled @p label, which is the same
+  /// for every line. Throws trase::Exception if there is no such column
+  ///
+  /// Looking up a label searches all the labels, so a filter that is called
+  /// for many lines can find the index once (e.g. on the first line it is
+  /// called for) and then use the accessors taking an index
+  size_t index(const std::string &label) const;
+
+  /// returns the text of the field in the column labelled @p label. Throws
+  /// trase::Exception if there is no such column
+  std::string string(const std::string &label) const;
+
+  /// returns the text of the field in column @p i. Throws std::out_of_range
+  /// if there is no such column
+  std::string string(size_t i) const;
+
+  /// returns the field in the column labelled @p label as a number, or NaN if
+  /// it is empty or not a number. Throws trase::Exception if there is no such
+  /// column
+  double number(const std::string &label) const;
+
+  /// returns the field in column @p i as a number, see number(). Throws
+  /// std::out_of_range if there is no such column
+  double number(size_t i) const;
+
+private:
+  const field_t &field(size_t i) const;
+
+  /// the labels of all columns of the csv file
+  const std::vector<std::string> &m_labels;
+
+  /// the fields of the line
+  const std::vector<field_t> &m_fields;
+};
+
+class CSVReader;
+struct CSVStreamState;
+
+/// Parses a csv file that arrives in pieces, e.g. while it is downloaded (see
+/// CSVDownloader). Use CSVReader::stream() to create one
+///
+/// Each write() parses the complete lines it is given straight away and only
+/// keeps the last, partial line until the next write(), so the whole file is
+/// never held in memory. The results are the same as for CSVReader. As the
+/// earlier lines are gone by the time a column turns out not to be numeric,
+/// the text of a number is also kept while the column is parsed as numbers
+/// if it cannot be written again from the number (e.g. "007", "1.50" or
+/// digits past the precision of a float)
+class CSVStream {
+public:
+  /// constructs a stream for the csv format and columns set in @p reader. If
+  /// @p labels is empty, the first line is assumed to contain the column
+  /// labels
+  CSVStream(const CSVReader &reader, std::vector<std::string> labels);
+
+  CSVStream(CSVStream &&other);
+  CSVStream &operator=(CSVStream &&other);
+  ~CSVStream();
+
+  /// parses the next @p size bytes @p data of the csv file
+  ///
+  /// Throws trase::Exception if a line has a different number of fields to
+  /// the labels
+  void write(const char *data, size_t size);
+
+  /// returns true once the row limit (see CSVReader::set_max_rows()) is
+  /// reached, after which further writes are ignored
+  bool done() const;
+
+  /// parses the last line of the csv file and returns its columns
+  CSVData finish();
+
+private:
+  /// parses the complete lines in [@p begin, @p end)
+  void parse(const char *begin, const char *end);
+
+  /// the start of a line that is continued by the next write()
+  std::string m_partial;
+
+  /// the format, and the columns parsed so far
+  std::unique_ptr<CSVStreamState> m_state;
+};
+
+/// Reads a csv file from the local file system
+///
+/// The file is memory mapped and split at row boundaries into chunks that are
+/// parsed in parallel, one thread per chunk. Delimiters and line endings are
+/// found 16 bytes at a time using SSE2 where available. Numbers are parsed
+/// directly into float columns and strings are dictionary encoded, so no
+/// string is allocated per field.
+///
+/// Empty fields are kept (e.g. "1,,3" has three fields), lines that only
+/// contain whitespace are skipped and Windows line endings are accepted.
+/// Quoted fields are not supported
+///
+/// Only some of the columns can be read (see set_columns()), and rows can be
+/// filtered (see set_filter()) or limited (see set_max_rows()) while the file
+/// is parsed, so that the fields that are not needed are never stored
+class CSVReader {
+public:
+  /// constructs a csv reader with default delimiter of ',' that uses all
+  /// hardware threads
+  CSVReader();
+
+  /// read the csv file @p filename
+  ///
+  /// @param filename path of the csv file
+  /// @param labels if empty, the first line of the csv file is assumed to
+  /// contain the column labels. If not empty, this vector contains the column
+  /// labels
+  ///
+  /// Throws trase::Exception if the file cannot be read or its lines have
+  /// differing numbers of fields
+  CSVData read(const std::string &filename,
+               const std::vector<std::string> &labels = {}) const;
+
+  /// parse the csv data in the buffer [@p begin, @p end), see read()
+  CSVData parse(const char *begin, const char *end,
+                const std::vector<std::string> &labels = {}) const;
+
+  /// returns a stream that parses a csv file given in pieces (see CSVStream),
+  /// with the delimiter of this reader
+  CSVStream stream(const std::vector<std::string> &labels = {}) const;
+
+  /// set the delimiter for the csv file format
+  void set_delim(const char arg) { m_delim = arg; }
+
+  /// set the maximum number of threads used to parse a file, 0 (the default)
+  /// uses std::thread::hardware_concurrency() threads
+  void set_threads(const size_t threads) { m_threads = threads; }
+
+  /// only read the columns labelled @p columns, in the given order. The
+  /// other fields of each line are skipped without being parsed, or even
+  /// split if they follow the last of the columns and no filter is set (the
+  /// delimiters of these are only counted, to check the number of fields of
+  /// each line). An empty vector (the default) reads all columns. Reading
+  /// throws trase::Exception if a column is not in the file
+  void set_columns(std::vector<std::string> columns) {
+    m_columns = std::move(columns);
+  }
+
+  /// only read the lines for which @p filter returns true. The filter is
+  /// called from several threads at once, and might be called more than once
+  /// for a line, so it must not have side effects. An empty function (the
+  /// default) reads all lines
+  void set_filter(std::function<bool(const CSVRow &)> filter) {
+    m_filter = std::move(filter);
+  }
+
+  /// stop reading after @p rows rows (counting only the lines that pass the
+  /// filter, see set_filter()). A file with a row limit is parsed by a
+  /// single thread, which stops at the limit. A limit of 0 (the default)
+  /// reads all rows
+  void set_max_rows(const size_t rows) { m_max_rows = rows; }
+
+private:
+  friend struct CSVStreamState;
+
+  /// delimiter for the csv file format
+  char m_delim;
+
+  /// maximum number of parsing threads, or 0 for one per hardware thread
+  size_t m_threads;
+
+  /// the labels of the columns to read, or empty to read all columns
+  std::vector<std::string> m_columns;
+
+  /// lines for which this returns false are skipped, if set
+  std::function<bool(const CSVRow &)> m_filter;
+
+  /// the maximum number of rows to read, or 0 for no limit
+  size_t m_max_rows;
+};
+
+} // namespace trase
+
+#endif // CSV_READER_H_
@@ -0,0 +1,604 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file Column.hpp
+
+#ifndef COLUMN_H_
+#define COLUMN_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "util/ColumnIterator.hpp"
+#include "util/MinMax.hpp"
+
+namespace trase {
+
+/// A single column of float data, used as the storage for each column of
+/// RawData
+///
+/// A column either owns its values, or borrows an externally owned buffer
+/// given by a pointer, a length and a stride. A borrowed buffer is not
+/// copied, and can optionally be kept alive by a `std::shared_ptr` held by the
+/// column.
+///
+/// A column can also be offset encoded, this is used to store high precision
+/// data (for example epoch timestamps) in 4-byte floats. Each element is then
+/// the float difference from a double precision offset held by the column,
+/// see offset_encoded() and ColumnIterator::decode().
+///
+/// A column can be a view that selects a subset of the rows of another
+/// column, see select(). The view shares the buffer of the parent column.
+///
+/// A column can be given a fixed capacity, see set_capacity(). It is then a
+/// ring buffer, once full each push_back() overwrites the oldest element
+/// without reallocating.
+///
+/// A column can be quantised to 16 bits to reduce its memory use, see
+/// quantised(). Each element is then stored as a 16-bit integer, which is
+/// scaled back to a float by ColumnIterator.
+///
+/// A range column holds a regularly spaced sequence (e.g. the sample times of
+/// a uniformly sampled signal) and stores no data at all, see range().
+///
+/// Copies of a column share the same buffer. The buffer is never modified in
+/// place while it is shared, a column that is appended to will first copy the
+/// data into a new buffer owned by that column alone.
+class Column {
+  /// owned values, nullptr if the column is borrowed
+  std::shared_ptr<std::vector<float>> m_values;
+
+  /// quantised values, nullptr if the column is not quantised
+  std::shared_ptr<std::vector<uint16_t>> m_quantised;
+
+  /// the stored value of each quantised element is its integer times m_scale
+  float m_scale{0.f};
+
+  /// the stored value of element i of a range column is i times m_step
+  double m_step{0.0};
+
+  /// true if this is a range column, which has no buffer
+  bool m_range{false};
+
+  /// optionally keeps a borrowed buffer alive
+  std::shared_ptr<const void> m_owner;
+
+  /// start of the column buffer
+  const float *m_data{nullptr};
+
+  /// number of elements in the column
+  size_t m_size{0};
+
+  /// distance between consecutive elements in the buffer
+  std::ptrdiff_t m_stride{1};
+
+  /// offset added to each element to decode it
+  double m_offset{0.0};
+
+  /// selected rows of the buffer, nullptr if all rows are used
+  std::shared_ptr<const std::vector<size_t>> m_rows;
+
+  /// capacity of a ring buffer column, 0 if the column can grow unbounded
+  size_t m_capacity{0};
+
+  /// row of the buffer holding the first element of a ring buffer column
+  size_t m_head{0};
+
+  /// sequence number (i.e. the number of elements appended before it) of the
+  /// first element of a ring buffer column
+  uint64_t m_first{0};
+
+  /// sequence numbers of the candidate min/max elements of a ring buffer
+  /// column, in increasing order. The values of these are increasing (for
+  /// m_window_min) or decreasing (for m_window_max), so the front of each is
+  /// the current min/max
+  std::deque<uint64_t> m_window_min;
+  std::deque<uint64_t> m_window_max;
+
+  /// cached min/max of the column, for columns that are not ring buffers
+  mutable bool m_has_minmax{false};
+  mutable float m_min{0};
+  mutable float m_max{0};
+
+  /// cached sortedness of the column, see is_sorted()
+  mutable bool m_has_sorted{false};
+  mutable bool m_sorted{false};
+
+  /// cached number of distinct values in the column, see distinct()
+  mutable bool m_has_distinct{false};
+  mutable size_t m_distinct{0};
+
+public:
+  /// construct an empty column
+  Column() : Column(std::vector<float>()) {}
+
+  /// construct a column that owns @p values, each decoded by adding
+  /// @p offset
+  explicit Column(std::vector<float> values, const double offset = 0.0)
+      : m_values(std::make_shared<std::vector<float>>(std::move(values))),
+        m_data(m_values->data()), m_size(m_values->size()), m_offset(offset) {}
+
+  /// construct a column that borrows an external buffer without copying it
+  ///
+  /// @param data pointer to the first element of the column
+  /// @param size number of elements in the column
+  /// @param stride distance (in floats) between consecutive elements. A
+  /// stride of 0 repeats the first element for every row
+  /// @param owner optional pointer that keeps the buffer alive for the
+  /// lifetime of this column (and any copies of it). If this is empty the
+  /// caller must ensure that the buffer outlives the column
+  Column(const float *data, size_t size, std::ptrdiff_t stride = 1,
+         std::shared_ptr<const void> owner = nullptr)
+      : m_owner(std::move(owner)), m_data(data), m_size(size),
+        m_stride(stride) {}
+
+  /// construct an offset encoded column from high precision @p values (e.g.
+  /// double or int64_t timestamps)
+  ///
+  /// The offset is set to the minimum value, and each element is stored as
+  /// the float difference from this offset. The difference is taken using the
+  /// type T, so for integer types this is exact before rounding to float.
+  template <typename T>
+  static Column offset_encoded(const std::vector<T> &values) {
+    if (values.empty()) {
+      return Column();
+    }
+    const T min = *std::min_element(values.begin(), values.end());
+    std::vector<float> differences(values.size());
+    std::transform(values.begin(), values.end(), differences.begin(),
+                   [min](const T &i) { return static_cast<float>(i - min); });
+    return Column(std::move(differences), static_cast<double>(min));
+  }
+
+  /// construct a range column of @p size elements, start, start + step,
+  /// start + 2 * step, ... No data is stored, each element is calculated as
+  /// it is accessed (see ColumnIterator), and the min/max is known without
+  /// iterating over the column
+  static Column range(const double start, const double step,
+                      const size_t size) {
+    Column column;
+    column.m_values.reset();
+    column.m_data = nullptr;
+    column.m_size = size;
+    column.m_offset = start;
+    column.m_step = step;
+    column.m_range = true;
+    return column;
+  }
+
+  /// return the number of elements in the column
+  size_t size() const { return m_size; }
+
+  /// return the offset that is added to each element to decode it
+  double offset() const { return m_offset; }
+
+  /// returns true if the column refers to an externally owned buffer
+  bool is_borrowed() const { return !m_values && !m_quantised && !m_range; }
+
+  /// returns true if this is a range column, see range()
+  bool is_range() const { return m_range; }
+
+  /// returns true if the column is a view of selected rows of a buffer
+  bool is_view() const { return m_rows != nullptr; }
+
+  /// return the capacity of a ring buffer column, or 0 if the column can
+  /// grow unbounded
+  size_t capacity() const { return m_capacity; }
+
+  /// make this column a ring buffer holding at most @p capacity elements,
+  /// keeping the last @p capacity elements of the column. A capacity of 0
+  /// lets the column grow unbounded again
+  void set_capacity(const size_t capacity) {
+    const size_t n =
+        capacity == 0 ? m_size : std::min<size_t>(m_size, capacity);
+    Column column(std::vector<float>(end() - static_cast<std::ptrdiff_t>(n),
+                                     end()),
+                  m_offset);
+    *this = std::move(column);
+    m_capacity = capacity;
+    if (m_capacity) {
+      m_values->reserve(m_capacity);
+      m_data = m_values->data();
+      for (size_t i = 0; i < m_size; ++i) {
+        push_window(i);
+      }
+    }
+  }
+
+  /// return a view of this column containing the given @p rows, the buffer is
+  /// shared and not copied
+  Column select(std::shared_ptr<const std::vector<size_t>> rows) const {
+    Column view(*this);
+    if (m_rows || m_head) {
+      // compose the selections so that the view indexes the buffer directly
+      auto composed = std::make_shared<std::vector<size_t>>(rows->size());
+      std::transform(rows->begin(), rows->end(), composed->begin(),
+                     [this](const size_t i) { return buffer_row(i); });
+      rows = std::move(composed);
+    }
+    view.m_size = rows->size();
+    view.m_rows = std::move(rows);
+    view.m_capacity = 0;
+    view.m_head = 0;
+    view.m_window_min.clear();
+    view.m_window_max.clear();
+    view.m_has_minmax = false;
+    view.m_has_sorted = false;
+    view.m_has_distinct = false;
+    return view;
+  }
+
+  /// return the min/max of the stored (i.e. not decoded) values. NaN values
+  /// (e.g. missing data) are ignored, the min/max of an empty column or one of
+  /// only NaN values is NaN
+  ///
+  /// this is calculated once and then updated as the column is appended to
+  /// (copies of the column keep the calculated min/max). For ring buffer
+  /// columns the min/max is updated in O(1) amortised time as elements are
+  /// overwritten
+  std::pair<float, float> minmax() const {
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    if (m_size == 0) {
+      return {nan, nan};
+    }
+    if (m_range && !m_rows) {
+      const auto last = static_cast<float>(range_last());
+      return last < 0.f ? std::make_pair(last, 0.f) : std::make_pair(0.f, last);
+    }
+    if (m_capacity) {
+      if (m_window_min.empty()) {
+        // every element in the window is NaN
+        return {nan, nan};
+      }
+      return {at(m_window_min.front()), at(m_window_max.front())};
+    }
+    if (!m_has_minmax) {
+      auto b = begin();
+      auto e = end();
+      // skip leading NaN values, later NaN values are ignored below
+      while (b != e && std::isnan(*b)) {
+        ++b;
+      }
+      if (b == e) {
+        m_min = m_max = nan;
+      } else if (b.is_contiguous()) {
+        // stride 1 fast path, use the SIMD kernel over the raw column buffer
+        std::tie(m_min, m_max) = contiguous_minmax(b.get(), e.get());
+      } else {
+        auto min_max = std::minmax_element(b, e);
+        m_min = *min_max.first;
+        m_max = *min_max.second;
+      }
+      m_has_minmax = true;
+    }
+    return {m_min, m_max};
+  }
+
+  /// return the min/max of the decoded values, i.e. minmax() plus the offset.
+  /// For a range column (or a view of one) these are calculated in double
+  /// precision from the start and step, rather than from the rounded stored
+  /// values
+  std::pair<double, double> decoded_minmax() const {
+    if (m_range && !m_rows && m_size > 0) {
+      const double last = m_offset + range_last();
+      return last < m_offset ? std::make_pair(last, m_offset)
+                             : std::make_pair(m_offset, last);
+    }
+    if (m_range && m_size > 0) {
+      const auto first = begin();
+      std::pair<double, double> min_max(first.decode(0), first.decode(0));
+      for (size_t i = 1; i < m_size; ++i) {
+        const double value = first.decode(static_cast<std::ptrdiff_t>(i));
+        min_max.first = std::min(min_max.first, value);
+        min_max.second = std::max(min_max.second, value);
+      }
+      return min_max;
+    }
+    const auto min_max = minmax();
+    return {m_offset + min_max.first, m_offset + min_max.second};
+  }
+
+  /// returns true if this column holds exactly the same elements as
+  /// @p other, i.e. the same offset and bitwise identical stored values. The
+  /// buffers, strides and selections of the two columns can differ
+  bool same_values(const Column &other) const {
+    if (m_size != other.m_size || m_offset != other.m_offset) {
+      return false;
+    }
+    if (m_data == other.m_data && m_quantised == other.m_quantised &&
+        m_scale == other.m_scale && m_step == other.m_step &&
+        m_range == other.m_range && m_stride == other.m_stride &&
+        m_rows == other.m_rows && m_head == other.m_head) {
+      return true;
+    }
+    return std::equal(begin(), end(), other.begin(),
+                      [](const float a, const float b) {
+                        return float_bits(a) == float_bits(b);
+                      });
+  }
+
+  /// returns the bit pattern of the float @p value
+  static uint32_t float_bits(const float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+
+  /// returns true if the column stores 16-bit quantised values
+  bool is_quantised() const { return m_quantised != nullptr; }
+
+  /// return a copy of this column quantised to 16 bits, using half the memory
+  /// of a float column
+  ///
+  /// The range between the min and max finite elements is divided into 65534
+  /// equal steps, and each element is rounded to the nearest step. The min
+  /// element is kept exactly (it becomes the offset of the returned column)
+  /// and the error of every other element is at most half a step. Elements
+  /// that are not finite (e.g. missing values stored as NaN) are stored as
+  /// ColumnIterator::nan_code, which reads back as NaN. Ring buffer columns
+  /// are overwritten in place and range columns store no data, so both are
+  /// returned as is
+  Column quantised() const {
+    if (m_size == 0 || m_capacity || m_range) {
+      return *this;
+    }
+    float min = std::numeric_limits<float>::max();
+    float max = std::numeric_limits<float>::lowest();
+    std::for_each(begin(), end(), [&](const float value) {
+      if (std::isfinite(value)) {
+        min = std::min(min, value);
+        max = std::max(max, value);
+      }
+    });
+    if (min > max) {
+      min = max = 0.f;
+    }
+    const uint16_t max_code = ColumnIterator::nan_code - 1;
+    const float scale = (max - min) / max_code;
+    auto values = std::make_shared<std::vector<uint16_t>>(m_size);
+    std::transform(begin(), end(), values->begin(), [&](const float value) {
+      if (!std::isfinite(value)) {
+        return ColumnIterator::nan_code;
+      }
+      if (scale == 0.f) {
+        return uint16_t(0);
+      }
+      return static_cast<uint16_t>(
+          std::min<long>(std::lround((value - min) / scale), max_code));
+    });
+    Column column;
+    column.m_values.reset();
+    column.m_quantised = std::move(values);
+    column.m_scale = scale;
+    column.m_data = nullptr;
+    column.m_size = m_size;
+    column.m_offset = m_offset + min;
+    return column;
+  }
+
+  /// returns true if the stored values are sorted in non-decreasing order
+  /// (e.g. the x values of a time series), so that algorithms can binary
+  /// search the column
+  ///
+  /// as for minmax(), this is calculated once and then kept up to date as the
+  /// column is appended to
+  bool is_sorted() const {
+    if (!m_has_sorted) {
+      m_sorted = m_range && !m_rows ? m_step >= 0.0
+                                    : std::is_sorted(begin(), end());
+      m_has_sorted = true;
+    }
+    return m_sorted;
+  }
+
+  /// returns the number of distinct stored values in the column
+  ///
+  /// this is calculated once, by counting the changes between neighbouring
+  /// values of a sorted column or otherwise by hashing the values, and is
+  /// kept up to date as a sorted column is appended to
+  size_t distinct() const {
+    if (!m_has_distinct) {
+      if (m_size == 0) {
+        m_distinct = 0;
+      } else if (m_range && !m_rows) {
+        m_distinct = m_step == 0.0 ? 1 : m_size;
+      } else if (is_sorted()) {
+        m_distinct = 1;
+        for (auto i = begin() + 1; i != end(); ++i) {
+          if (i[-1] != *i) {
+            ++m_distinct;
+          }
+        }
+      } else {
+        std::unordered_set<uint32_t> values;
+        for (auto i = begin(); i != end(); ++i) {
+          values.insert(float_bits(*i));
+        }
+        m_distinct = values.size();
+      }
+      m_has_distinct = true;
+    }
+    return m_distinct;
+  }
+
+  /// return a ColumnIterator to the beginning of the column
+  ColumnIterator begin() const { return iterator(0); }
+
+  /// return a ColumnIterator to the end of the column
+  ColumnIterator end() const {
+    return iterator(static_cast<std::ptrdiff_t>(m_size));
+  }
+
+  /// append @p value to the end of the column, this is encoded by
+  /// subtracting the column offset. If the column is a full ring buffer then
+  /// the oldest element is overwritten
+  ///
+  /// if the buffer is borrowed, quantised, shared with another column or the
+  /// column is a view or a range then the data is first copied into a new
+  /// float buffer owned by this column
+  void push_back(const double value) {
+    const auto stored = static_cast<float>(value - m_offset);
+    update_stats(stored);
+    if (is_borrowed() || is_quantised() || is_range() || is_view() ||
+        m_values.use_count() > 1) {
+      copy_to_owned();
+    }
+    if (m_capacity && m_size == m_capacity) {
+      (*m_values)[m_head] = stored;
+      m_head = m_head + 1 == m_capacity ? 0 : m_head + 1;
+      ++m_first;
+      while (!m_window_min.empty() && m_window_min.front() < m_first) {
+        m_window_min.pop_front();
+      }
+      while (!m_window_max.empty() && m_window_max.front() < m_first) {
+        m_window_max.pop_front();
+      }
+    } else {
+      m_values->push_back(stored);
+      m_data = m_values->data();
+      m_size = m_values->size();
+    }
+    if (m_capacity) {
+      push_window(m_size - 1);
+    } else if (m_has_minmax && !std::isnan(stored)) {
+      // the min/max of a column of only NaN values is NaN
+      m_min = std::isnan(m_min) ? stored : std::min(m_min, stored);
+      m_max = std::isnan(m_max) ? stored : std::max(m_max, stored);
+    }
+  }
+
+private:
+  /// updates the cached sortedness and number of distinct values for a new
+  /// element @p stored appended to the column
+  void update_stats(const float stored) {
+    if (m_size == 0) {
+      m_has_sorted = false;
+      m_has_distinct = false;
+      return;
+    }
+    const bool full = m_capacity && m_size == m_capacity;
+    const float last = begin()[static_cast<std::ptrdiff_t>(m_size - 1)];
+    const bool sorted = m_has_sorted && m_sorted && !(stored < last);
+    if (m_has_distinct && sorted && !full) {
+      m_distinct += stored != last;
+    } else {
+      m_has_distinct = false;
+    }
+    // dropping the oldest element of a full ring buffer keeps a sorted column
+    // sorted, but might also sort an unsorted one
+    if (m_has_sorted) {
+      m_has_sorted = sorted || !full;
+      m_sorted = sorted;
+    }
+  }
+
+  ColumnIterator iterator(const std::ptrdiff_t index) const {
+    return {m_data,
+            m_stride,
+            index,
+            m_offset,
+            m_rows ? m_rows->data() : nullptr,
+            static_cast<std::ptrdiff_t>(m_head),
+            m_head ? static_cast<std::ptrdiff_t>(m_capacity) : 0,
+            m_quantised ? m_quantised->data() : nullptr,
+            m_scale,
+            m_step};
+  }
+
+  /// returns the stored value of the last element of a range column
+  double range_last() const {
+    return m_step * static_cast<double>(m_size - 1);
+  }
+
+  /// returns the row of the buffer holding element i
+  size_t buffer_row(const size_t i) const {
+    if (m_rows) {
+      return (*m_rows)[i];
+    }
+    const size_t j = m_head + i;
+    return m_capacity && j >= m_capacity ? j - m_capacity : j;
+  }
+
+  /// returns the stored value of the element with sequence number @p seq
+  float at(const uint64_t seq) const {
+    return begin()[static_cast<std::ptrdiff_t>(seq - m_first)];
+  }
+
+  /// adds element i to the candidate min/max elements of a ring buffer,
+  /// unless it is NaN
+  void push_window(const size_t i) {
+    const uint64_t seq = m_first + i;
+    const float value = at(seq);
+    if (std::isnan(value)) {
+      return;
+    }
+    while (!m_window_min.empty() && at(m_window_min.back()) >= value) {
+      m_window_min.pop_back();
+    }
+    m_window_min.push_back(seq);
+    while (!m_window_max.empty() && at(m_window_max.back()) <= value) {
+      m_window_max.pop_back();
+    }
+    m_window_max.push_back(seq);
+  }
+
+  /// copies the elements into a new buffer owned by this column alone, in
+  /// order and with the head at the start of the buffer
+  void copy_to_owned() {
+    auto values = std::make_shared<std::vector<float>>(begin(), end());
+    values->reserve(m_capacity);
+    m_values = std::move(values);
+    m_quantised.reset();
+    m_scale = 0.f;
+    m_step = 0.0;
+    m_range = false;
+    m_owner.reset();
+    m_data = m_values->data();
+    m_stride = 1;
+    m_rows.reset();
+    m_head = 0;
+  }
+};
+
+} // namespace trase
+
+#endif // COLUMN_H_
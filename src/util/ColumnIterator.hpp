@@ -36,24 +36,94 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef COLUMNITERATOR_H_
 #define COLUMNITERATOR_H_
 
-#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
 
 namespace trase {
 
 /// A const iterator that iterates through a single column of the raw data class
 /// Impliments an random access iterator with a given stride
+///
+/// The iterator holds the start of the column buffer and a 64-bit row index,
+/// so columns are not limited to 2^31 rows. A stride of 0 repeats the first
+/// element of the buffer for every row.
+///
+/// The elements of an offset encoded column (see Column) are the differences
+/// from a double precision offset. Dereferencing the iterator gives the stored
+/// difference, use decode() to get the full precision value.
+///
+/// The buffer of a ring buffer column wraps around, so element i is at row
+/// (start + i) modulo wrap of the buffer when wrap is non-zero.
+///
+/// An iterator can also be given a selection of rows, in which case element i
+/// is row rows[i] of the buffer. This is used for views of a column (e.g.
+/// facets) that share the buffer of the parent column.
+///
+/// The buffer of a quantised column holds 16-bit integers rather than floats,
+/// each of these is multiplied by a scale as the iterator is dereferenced
+/// (except for nan_code, which is NaN). Elements are therefore returned by
+/// value rather than by reference.
+///
+/// A range column has no buffer at all, element i is simply i times the
+/// step (plus the offset when decoded), calculated in double precision.
+///
+/// Columns stored by RawData are normally contiguous and have a stride of 1,
+/// algorithms that can take advantage of this can use is_contiguous() and
+/// get() to access the underlying buffer directly
 class ColumnIterator {
 public:
   using pointer = float const *;
   using iterator_category = std::random_access_iterator_tag;
-  using reference = float const &;
+  using reference = float;
   using value_type = float const;
   using difference_type = std::ptrdiff_t;
 
+  /// the integer of a quantised element that is NaN
+  static const uint16_t nan_code = 65535;
+
   ColumnIterator() = default;
 
-  ColumnIterator(const std::vector<float>::const_iterator &p, const int stride)
-      : m_p(&(*p)), m_stride(stride) {}
+  ColumnIterator(pointer p, const difference_type stride,
+                 const difference_type index = 0, const double offset = 0.0,
+                 const size_t *rows = nullptr, const difference_type start = 0,
+                 const difference_type wrap = 0,
+                 const uint16_t *quantised = nullptr, const float scale = 0.f,
+                 const double step = 0.0)
+      : m_p(p), m_stride(stride), m_index(index), m_offset(offset),
+        m_rows(rows), m_start(start), m_wrap(wrap), m_quantised(quantised),
+        m_scale(scale), m_step(step) {}
+
+  /// returns the pointer to the current element, this is nullptr for a
+  /// quantised or range column
+  pointer get() const {
+    return m_p ? m_p + row(m_index) * m_stride : nullptr;
+  }
+
+  /// returns the stride between consecutive elements
+  difference_type stride() const { return m_stride; }
+
+  /// returns true if consecutive elements are adjacent in memory
+  bool is_contiguous() const {
+    return m_p != nullptr && m_stride == 1 && m_rows == nullptr &&
+           m_wrap == 0;
+  }
+
+  /// returns true if the elements are those of a range column, which has no
+  /// buffer
+  bool is_range() const { return !m_p && !m_quantised; }
+
+  /// returns the offset that is added to each element to decode it
+  double offset() const { return m_offset; }
+
+  /// returns the decoded (i.e. offset + stored) value of element i
+  double decode(const difference_type i) const {
+    if (is_range()) {
+      return m_offset + range_element(row(m_index + i) * m_stride);
+    }
+    return m_offset + operator[](i);
+  }
 
   reference operator*() const { return dereference(); }
 
@@ -70,16 +140,43 @@ public:
     return tmp;
   }
 
-  ColumnIterator operator+(int n) const {
+  ColumnIterator &operator--() {
+    increment(-1);
+    return *this;
+  }
+
+  const ColumnIterator operator--(int) {
+    ColumnIterator tmp(*this);
+    operator--();
+    return tmp;
+  }
+
+  ColumnIterator operator+(const difference_type n) const {
     ColumnIterator tmp(*this);
     tmp.increment(n);
     return tmp;
   }
 
-  reference operator[](const int i) const { return operator+(i).dereference(); }
+  ColumnIterator operator-(const difference_type n) const {
+    return operator+(-n);
+  }
 
-  size_t operator-(const ColumnIterator &start) const {
-    return (m_p - start.m_p) / m_stride;
+  ColumnIterator &operator+=(const difference_type n) {
+    increment(n);
+    return *this;
+  }
+
+  ColumnIterator &operator-=(const difference_type n) {
+    increment(-n);
+    return *this;
+  }
+
+  reference operator[](const difference_type i) const {
+    return element(row(m_index + i) * m_stride);
+  }
+
+  difference_type operator-(const ColumnIterator &start) const {
+    return m_index - start.m_index;
   }
 
   inline bool operator==(const ColumnIterator &rhs) const { return equal(rhs); }
@@ -88,17 +185,61 @@ public:
     return !operator==(rhs);
   }
 
+  inline bool operator<(const ColumnIterator &rhs) const {
+    return m_index < rhs.m_index;
+  }
+
 private:
-  bool equal(ColumnIterator const &other) const { return m_p == other.m_p; }
+  bool equal(ColumnIterator const &other) const {
+    return m_index == other.m_index;
+  }
+
+  reference dereference() const { return element(row(m_index) * m_stride); }
+
+  /// returns the element at position i of the buffer
+  reference element(const difference_type i) const {
+    if (m_p) {
+      return m_p[i];
+    }
+    if (m_quantised) {
+      return m_quantised[i] == nan_code
+                 ? std::numeric_limits<float>::quiet_NaN()
+                 : m_scale * m_quantised[i];
+    }
+    return static_cast<float>(range_element(i));
+  }
+
+  /// returns element i of a range column
+  double range_element(const difference_type i) const {
+    return m_step * static_cast<double>(i);
+  }
 
-  reference dereference() const { return *m_p; }
+  /// returns the row of the buffer that holds element i
+  difference_type row(const difference_type i) const {
+    if (m_rows) {
+      return static_cast<difference_type>(m_rows[i]);
+    }
+    if (m_wrap) {
+      const difference_type j = m_start + i;
+      return j >= m_wrap ? j - m_wrap : j;
+    }
+    return i;
+  }
 
-  void increment() { std::advance(m_p, m_stride); }
+  void increment() { ++m_index; }
 
-  void increment(const int n) { std::advance(m_p, n * m_stride); }
+  void increment(const difference_type n) { m_index += n; }
 
-  pointer m_p;
-  int m_stride;
+  pointer m_p{nullptr};
+  difference_type m_stride{1};
+  difference_type m_index{0};
+  double m_offset{0.0};
+  const size_t *m_rows{nullptr};
+  difference_type m_start{0};
+  difference_type m_wrap{0};
+  const uint16_t *m_quantised{nullptr};
+  float m_scale{0.f};
+  double m_step{0.0};
 };
 
 } // namespace trase
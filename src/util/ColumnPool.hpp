@@ -0,0 +1,105 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file ColumnPool.hpp
+
+#ifndef COLUMNPOOL_H_
+#define COLUMNPOOL_H_
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+#include "util/Column.hpp"
+
+namespace trase {
+
+/// A set of columns identified by their contents, used to share the buffers
+/// of identical columns between data sets (e.g. between the animation frames
+/// of a geometry, which often repeat the same x or color data)
+///
+/// Columns are shared using the copy-on-write semantics of Column, so a shared
+/// buffer is only copied if one of the columns is later appended to
+class ColumnPool {
+  /// the interned columns, keyed by the hash of their contents
+  std::unordered_multimap<uint64_t, Column> m_columns;
+
+public:
+  /// returns a column with the same contents as @p column (see
+  /// Column::same_values()). If an identical column has previously been
+  /// interned this is a copy of that column, sharing its buffer, otherwise
+  /// @p column is added to the pool and returned
+  ///
+  /// ring buffer columns are modified in place, and borrowed columns point
+  /// to a buffer that may be modified or freed by its owner, so neither are
+  /// added to the pool or replaced by a column from it
+  Column intern(const Column &column) {
+    if (column.capacity() || column.is_borrowed()) {
+      return column;
+    }
+    const uint64_t key = hash(column);
+    auto range = m_columns.equal_range(key);
+    for (auto i = range.first; i != range.second; ++i) {
+      if (i->second.same_values(column)) {
+        return i->second;
+      }
+    }
+    m_columns.emplace(key, column);
+    return column;
+  }
+
+  /// return the number of distinct columns in the pool
+  size_t size() const { return m_columns.size(); }
+
+  /// returns the FNV-1a hash of the offset and stored values of @p column
+  static uint64_t hash(const Column &column) {
+    const uint64_t prime = 1099511628211ull;
+    uint64_t h = 14695981039346656037ull;
+    const auto combine = [&](const uint64_t value) {
+      h = (h ^ value) * prime;
+    };
+    uint64_t offset;
+    const double column_offset = column.offset();
+    std::memcpy(&offset, &column_offset, sizeof(offset));
+    combine(offset);
+    combine(column.size());
+    for (auto i = column.begin(); i != column.end(); ++i) {
+      combine(Column::float_bits(*i));
+    }
+    return h;
+  }
+};
+
+} // namespace trase
+
+#endif // COLUMNPOOL_H_
@@ -0,0 +1,108 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of trase.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/// \file MinMax.hpp
+
+#ifndef MINMAX_H_
+#define MINMAX_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+#include "util/Simd.hpp"
+
+namespace trase {
+
+/// returns the min/max of the contiguous range of floats [begin, end), which
+/// must not be empty
+///
+/// Uses the SIMD instructions available (see Simd.hpp). As for
+/// std::minmax_element, NaN values are ignored unless the first element is NaN
+inline std::pair<float, float> contiguous_minmax(const float *begin,
+                                                 const float *end) {
+  const float *i = begin;
+  float min = *begin;
+  float max = *begin;
+
+#if defined(TRASE_HAVE_AVX)
+  if (end - i >= 8) {
+    __m256 vmin = _mm256_set1_ps(min);
+    __m256 vmax = vmin;
+    for (; end - i >= 8; i += 8) {
+      const __m256 v = _mm256_loadu_ps(i);
+      // note: the second operand is returned if either is NaN
+      vmin = _mm256_min_ps(v, vmin);
+      vmax = _mm256_max_ps(v, vmax);
+    }
+    alignas(32) float mins[8];
+    alignas(32) float maxs[8];
+    _mm256_store_ps(mins, vmin);
+    _mm256_store_ps(maxs, vmax);
+    min = *std::min_element(mins, mins + 8);
+    max = *std::max_element(maxs, maxs + 8);
+  }
+#elif defined(TRASE_HAVE_SSE2)
+  if (end - i >= 4) {
+    __m128 vmin = _mm_set1_ps(min);
+    __m128 vmax = vmin;
+    for (; end - i >= 4; i += 4) {
+      const __m128 v = _mm_loadu_ps(i);
+      // note: the second operand is returned if either is NaN
+      vmin = _mm_min_ps(v, vmin);
+      vmax = _mm_max_ps(v, vmax);
+    }
+    alignas(16) float mins[4];
+    alignas(16) float maxs[4];
+    _mm_store_ps(mins, vmin);
+    _mm_store_ps(maxs, vmax);
+    min = *std::min_element(mins, mins + 4);
+    max = *std::max_element(maxs, maxs + 4);
+  }
+#endif
+
+  // remaining elements (or all of them without SIMD)
+  for (; i != end; ++i) {
+    if (*i < min) {
+      min = *i;
+    }
+    if (max < *i) {
+      max = *i;
+    }
+  }
+  return {min, max};
+}
+
+} // namespace trase
+
+#endif // MINMAX_H_
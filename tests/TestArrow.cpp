@@ -0,0 +1,234 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of the Oxford RSE C++ Template project.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "catch.hpp"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "trase.hpp"
+
+using namespace trase;
+
+namespace {
+
+// a minimal Arrow producer for the tests, each array holds its buffers and
+// children and counts how many times it is released
+struct TestArray {
+  ArrowArray array;
+  std::vector<const void *> buffers;
+  std::vector<ArrowArray *> children;
+  int *released;
+
+  TestArray(int64_t length, std::vector<const void *> buffers_,
+            int64_t null_count = 0, int *released_ = nullptr)
+      : buffers(std::move(buffers_)), released(released_) {
+    array.length = length;
+    array.null_count = null_count;
+    array.offset = 0;
+    array.n_buffers = static_cast<int64_t>(buffers.size());
+    array.n_children = 0;
+    array.buffers = buffers.data();
+    array.children = nullptr;
+    array.dictionary = nullptr;
+    array.release = [](ArrowArray *a) {
+      auto self = static_cast<TestArray *>(a->private_data);
+      if (self->released) {
+        ++*self->released;
+      }
+      a->release = nullptr;
+    };
+    array.private_data = this;
+  }
+};
+
+ArrowSchema make_schema(const char *format) {
+  ArrowSchema schema;
+  schema.format = format;
+  schema.name = "";
+  schema.metadata = nullptr;
+  schema.flags = ARROW_FLAG_NULLABLE;
+  schema.n_children = 0;
+  schema.children = nullptr;
+  schema.dictionary = nullptr;
+  schema.release = nullptr;
+  schema.private_data = nullptr;
+  return schema;
+}
+
+} // namespace
+
+TEST_CASE("import arrow float column without copying", "[arrow]") {
+  std::vector<float> x = {3, 1, 2, 5};
+  int released = 0;
+  TestArray array(4, {nullptr, x.data()}, 0, &released);
+  auto schema = make_schema("f");
+
+  {
+    auto data = import_arrow(&schema, &array.array);
+    CHECK(array.array.release == nullptr);
+    REQUIRE(data->cols() == 1);
+    REQUIRE(data->rows() == 4);
+    CHECK(data->begin(0).get() == x.data());
+    CHECK(data->minmax(0) == std::make_pair(1.f, 5.f));
+
+    // the array stays alive while a data set uses its buffers
+    DataWithAesthetic plot_data(data);
+    data.reset();
+    CHECK(released == 0);
+    plot_data.bind<Aesthetic::x>(0);
+    CHECK(plot_data.limits().bmax[Aesthetic::x::index] == 5.f);
+  }
+  CHECK(released == 1);
+}
+
+TEST_CASE("import arrow record batch", "[arrow]") {
+  std::vector<double> t = {1.5e9, 1.5e9 + 1, 1.5e9 + 2, -1};
+  std::vector<int32_t> n = {-2, 7, 0, 3};
+  std::vector<float> y = {1, 1000, 2, 3};
+  // element 1 of y and 3 of t are null
+  std::vector<uint8_t> y_valid = {0x0d};
+  std::vector<uint8_t> t_valid = {0x07};
+
+  TestArray t_array(4, {t_valid.data(), t.data()}, 1);
+  TestArray n_array(4, {nullptr, n.data()});
+  TestArray y_array(4, {y_valid.data(), y.data()}, 1);
+  int released = 0;
+  TestArray batch(4, {nullptr}, 0, &released);
+  std::vector<ArrowArray *> children = {&t_array.array, &n_array.array,
+                                        &y_array.array};
+  batch.array.n_children = 3;
+  batch.array.children = children.data();
+
+  auto t_schema = make_schema("g");
+  auto n_schema = make_schema("i");
+  auto y_schema = make_schema("f");
+  std::vector<ArrowSchema *> schema_children = {&t_schema, &n_schema,
+                                                &y_schema};
+  auto schema = make_schema("+s");
+  schema.n_children = 3;
+  schema.children = schema_children.data();
+
+  auto data = import_arrow(&schema, &batch.array);
+  REQUIRE(data->cols() == 3);
+  REQUIRE(data->rows() == 4);
+
+  // doubles are offset encoded, so keep their precision
+  CHECK(data->begin(0).decode(2) == 1.5e9 + 2);
+  CHECK(std::isnan(data->begin(0)[3]));
+  CHECK(data->begin(0).offset() == 1.5e9);
+  CHECK(data->begin(1).decode(0) == -2.0);
+  CHECK(data->begin(1).decode(1) == 7.0);
+
+  // nulls are ignored in the limits
+  CHECK(std::isnan(data->begin(2)[1]));
+  CHECK(data->begin(2).get() != y.data());
+  CHECK(data->minmax(2) == std::make_pair(1.f, 3.f));
+
+  // a slice of the batch
+  TestArray slice(2, {nullptr});
+  slice.array.offset = 2;
+  slice.array.n_children = 3;
+  slice.array.children = children.data();
+  auto sliced = import_arrow(&schema, &slice.array);
+  REQUIRE(sliced->rows() == 2);
+  CHECK(sliced->begin(1).decode(0) == 0.0);
+  CHECK(sliced->begin(2)[0] == 2.f);
+  CHECK(sliced->begin(2)[1] == 3.f);
+
+  // rows that are null in the batch are null in every column, also in the
+  // columns that have no nulls of their own
+  std::vector<uint8_t> batch_valid = {0x0b};
+  TestArray nulls(4, {batch_valid.data()}, 1);
+  nulls.array.n_children = 3;
+  nulls.array.children = children.data();
+  auto with_nulls = import_arrow(&schema, &nulls.array);
+  REQUIRE(with_nulls->rows() == 4);
+  for (size_t i = 0; i < 3; ++i) {
+    CHECK(std::isnan(with_nulls->begin(i)[2]));
+  }
+  CHECK(with_nulls->begin(1).decode(1) == 7.0);
+  CHECK(with_nulls->begin(1).decode(3) == 3.0);
+  CHECK(with_nulls->begin(2).get() != y.data());
+  CHECK(with_nulls->begin(2)[0] == 1.f);
+  CHECK(with_nulls->minmax(1) == std::make_pair(0.f, 9.f));
+
+  // the validity bitmap of a sliced batch starts at its offset
+  TestArray null_slice(2, {batch_valid.data()}, 1);
+  null_slice.array.offset = 2;
+  null_slice.array.n_children = 3;
+  null_slice.array.children = children.data();
+  auto sliced_nulls = import_arrow(&schema, &null_slice.array);
+  CHECK(std::isnan(sliced_nulls->begin(1)[0]));
+  CHECK(sliced_nulls->begin(1).decode(1) == 3.0);
+  CHECK(std::isnan(sliced_nulls->begin(2)[0]));
+  CHECK(sliced_nulls->begin(2)[1] == 3.f);
+
+  data.reset();
+  CHECK(released == 1);
+}
+
+TEST_CASE("import arrow dictionary column", "[arrow]") {
+  // dictionary of {"dog", "cat", "emu"} (not sorted)
+  std::vector<int32_t> offsets = {0, 3, 6, 9};
+  std::string chars = "dogcatemu";
+  TestArray dictionary(3, {nullptr, offsets.data(), chars.data()});
+  std::vector<int8_t> indices = {0, 1, 2, 1, 0};
+  std::vector<uint8_t> valid = {0x17};
+  TestArray array(5, {valid.data(), indices.data()}, 1);
+  array.array.dictionary = &dictionary.array;
+
+  auto value_schema = make_schema("u");
+  auto schema = make_schema("c");
+  schema.dictionary = &value_schema;
+
+  auto data = import_arrow(&schema, &array.array);
+  REQUIRE(data->cols() == 1);
+  const auto &strings = data->string_data(0);
+  REQUIRE(strings.size() == 3);
+  CHECK(strings[0] == "cat");
+  CHECK(strings[1] == "dog");
+  CHECK(strings[2] == "emu");
+  CHECK(strings[data->begin(0)[0]] == "dog");
+  CHECK(strings[data->begin(0)[1]] == "cat");
+  CHECK(strings[data->begin(0)[2]] == "emu");
+  CHECK(std::isnan(data->begin(0)[3]));
+  CHECK(strings[data->begin(0)[4]] == "dog");
+
+  // unsupported formats throw
+  std::vector<uint8_t> bools = {1};
+  TestArray bool_array(1, {nullptr, bools.data()});
+  auto bool_schema = make_schema("b");
+  CHECK_THROWS_AS(import_arrow(&bool_schema, &bool_array.array), Exception);
+}
@@ -33,31 +33,127 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "catch.hpp"
 
-#include <map>
-#include <type_traits>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#ifdef _WIN32
+#include <direct.h>
+#define getcwd _getcwd
+#else
+#include <unistd.h>
+#endif
 
 #include "trase.hpp"
 
 using namespace trase;
 
+namespace {
+
+// the decoded first value of a numeric column
+double first_number(const CSVData &csv, const std::string &name) {
+  return csv.data->begin(csv.column(name)).decode(0);
+}
+
+// the first string of a dictionary encoded column
+std::string first_string(const CSVData &csv, const std::string &name) {
+  const size_t i = csv.column(name);
+  return csv.data->string_data(i).at(static_cast<size_t>(*csv.data->begin(i)));
+}
+
+// writes @p contents to the file @p filename, and returns its file:// url
+std::string write_file(const std::string &filename,
+                       const std::string &contents) {
+  std::ofstream(filename, std::ios::binary) << contents;
+  char cwd[4096];
+  REQUIRE(getcwd(cwd, sizeof(cwd)) != nullptr);
+  return "file://" + std::string(cwd) + "/" + filename;
+}
+
+} // namespace
+
+TEST_CASE("download local file", "[csv downloader local]") {
+  // large enough to arrive in several pieces
+  std::string contents = "index\tname\n";
+  const size_t n = 100000;
+  for (size_t i = 0; i < n; ++i) {
+    contents += std::to_string(i) + "\tname_" + std::to_string(i % 3) + "\n";
+  }
+  const auto url = write_file("test_csv_downloader.tsv", contents);
+
+  CSVDownloader dl;
+  dl.set_delim('\t');
+  auto data = dl.download(url);
+  REQUIRE(data.names == std::vector<std::string>({"index", "name"}));
+  REQUIRE(data.data->rows() == n);
+  auto index = data.data->begin(data.column("index"));
+  CHECK(index.decode(n - 1) == n - 1);
+  CHECK(data.data->string_data(data.column("name")).size() == 3);
+
+  // the transfer stops at the row limit
+  dl.set_columns({"name"});
+  dl.set_max_rows(10);
+  data = dl.download(url);
+  CHECK(data.names == std::vector<std::string>({"name"}));
+  CHECK(data.data->rows() == 10);
+  dl.set_columns({});
+  dl.set_max_rows(0);
+
+  // parse errors are thrown once the transfer is aborted
+  write_file("test_csv_downloader.tsv", "a\tb\n1\t2\n3\n");
+  CHECK_THROWS_AS(dl.download(url), Exception);
+  std::remove("test_csv_downloader.tsv");
+
+  // as are transfer errors, as for download_all()
+  CHECK_THROWS_AS(dl.download(url), Exception);
+}
+
+TEST_CASE("download local files in a batch", "[csv downloader local]") {
+  const size_t n = 7;
+  std::vector<std::string> urls;
+  for (size_t i = 0; i < n; ++i) {
+    // shards of different lengths, so that they complete out of order
+    std::string contents = "shard,row\n";
+    for (size_t j = 0; j < 1000 * ((i * 3) % n + 1); ++j) {
+      contents += std::to_string(i) + "," + std::to_string(j) + "\n";
+    }
+    urls.push_back(write_file("test_csv_shard_" + std::to_string(i) + ".csv",
+                              contents));
+  }
+
+  CSVDownloader dl;
+  for (const size_t concurrency : {1, 3, 16}) {
+    dl.set_concurrency(concurrency);
+    auto shards = dl.download_all(urls);
+    REQUIRE(shards.size() == n);
+    for (size_t i = 0; i < n; ++i) {
+      REQUIRE(shards[i].names == std::vector<std::string>({"shard", "row"}));
+      CHECK(shards[i].data->rows() == 1000 * ((i * 3) % n + 1));
+      CHECK(shards[i].data->begin(shards[i].column("shard")).decode(0) == i);
+    }
+  }
+
+  // a transfer that fails throws once the others are complete
+  urls.push_back("file:///no/such/directory/test_csv_shard.csv");
+  CHECK_THROWS_AS(dl.download_all(urls), Exception);
+  for (size_t i = 0; i < n; ++i) {
+    std::remove(("test_csv_shard_" + std::to_string(i) + ".csv").c_str());
+  }
+}
+
 TEST_CASE("download test file", "[csv downloader]") {
   CSVDownloader dl;
   dl.set_delim('\t');
 #ifdef TRASE_HAVE_CURL
   auto data = dl.download("https://www.stat.ubc.ca/~jenny/notOcto/STAT545A/"
                           "examples/gapminder/data/gapminderDataFiveYear.txt");
-  std::map<std::string, std::string> expected;
-  expected["country"] = "Afghanistan";
-  expected["year"] = "1952";
-  expected["pop"] = "8425333";
-  expected["continent"] = "Asia";
-  expected["lifeExp"] = "28.801";
-  expected["gdpPercap"] = "779.4453145";
-  int i = 0;
-  for (auto it = data.begin(); it != data.end(); ++it, ++i) {
-    CHECK(it->second[0] == expected[it->first]);
-  }
-  CHECK(i == 6);
+  CHECK(data.names.size() == 6);
+  CHECK(first_string(data, "country") == "Afghanistan");
+  CHECK(first_number(data, "year") == 1952);
+  CHECK(first_number(data, "pop") == 8425333);
+  CHECK(first_string(data, "continent") == "Asia");
+  CHECK(first_number(data, "lifeExp") == Approx(28.801));
+  CHECK(first_number(data, "gdpPercap") == Approx(779.4453145));
 #else
   REQUIRE_THROWS_WITH(
       dl.download("https://www.stat.ubc.ca/~jenny/notOcto/STAT545A/"
@@ -72,16 +168,11 @@ TEST_CASE("download test file 2", "[csv downloader]") {
   auto data = dl.download(
       "http://archive.ics.uci.edu/ml/machine-learning-databases/iris/iris.data",
       {"sepal_length", "sepal_width", "petal_length", "petal_width", "class"});
-  std::map<std::string, std::string> expected;
-  expected["sepal_length"] = "5.1";
-  expected["sepal_width"] = "3.5";
-  expected["petal_length"] = "1.4";
-  expected["petal_width"] = "0.2";
-  expected["class"] = "Iris-setosa";
-  int i = 0;
-  for (auto it = data.begin(); it != data.end(); ++it, ++i) {
-    CHECK(it->second[0] == expected[it->first]);
-  }
-  CHECK(i == 5);
+  CHECK(data.names.size() == 5);
+  CHECK(first_number(data, "sepal_length") == Approx(5.1));
+  CHECK(first_number(data, "sepal_width") == Approx(3.5));
+  CHECK(first_number(data, "petal_length") == Approx(1.4));
+  CHECK(first_number(data, "petal_width") == Approx(0.2));
+  CHECK(first_string(data, "class") == "Iris-setosa");
 #endif
 }
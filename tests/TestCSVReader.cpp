@@ -0,0 +1,356 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of the Oxford RSE C++ Template project.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "trase.hpp"
+
+using namespace trase;
+
+namespace {
+
+void write_file(const std::string &filename, const std::string &contents) {
+  std::ofstream out(filename, std::ios::binary);
+  out << contents;
+}
+
+// the decoded values of a numeric column
+std::vector<double> numbers(const CSVData &csv, const std::string &name) {
+  const size_t i = csv.column(name);
+  std::vector<double> values(csv.data->rows());
+  for (size_t j = 0; j < values.size(); ++j) {
+    values[j] = csv.data->begin(i).decode(static_cast<std::ptrdiff_t>(j));
+  }
+  return values;
+}
+
+// the strings of a dictionary encoded column
+std::vector<std::string> strings(const CSVData &csv, const std::string &name) {
+  const size_t i = csv.column(name);
+  const auto &dictionary = csv.data->string_data(i);
+  std::vector<std::string> values;
+  for (auto j = csv.data->begin(i); j != csv.data->end(i); ++j) {
+    values.push_back(dictionary.at(static_cast<size_t>(*j)));
+  }
+  return values;
+}
+
+} // namespace
+
+TEST_CASE("read csv file", "[csv reader]") {
+  write_file("test_csv_reader.csv", "a,b,c\r\n"
+                                    "1,2.5,x\r\n"
+                                    "  \r\n"
+                                    "4,,y\r\n"
+                                    "7,8,x");
+  CSVReader reader;
+  auto csv = reader.read("test_csv_reader.csv");
+  CHECK(csv.names == std::vector<std::string>({"a", "b", "c"}));
+  CHECK(csv.data->rows() == 3);
+  CHECK(numbers(csv, "a") == std::vector<double>({1, 4, 7}));
+  CHECK(csv.data->string_data(csv.column("a")).empty());
+  CHECK(numbers(csv, "b")[0] == 2.5);
+  CHECK(std::isnan(numbers(csv, "b")[1]));
+  CHECK(numbers(csv, "b")[2] == 8);
+  CHECK(strings(csv, "c") == std::vector<std::string>({"x", "y", "x"}));
+  CHECK(csv.data->string_data(csv.column("c")) ==
+        std::vector<std::string>({"x", "y"}));
+  CHECK_THROWS_AS(csv.column("d"), Exception);
+
+  // given labels, the first line is data
+  csv = reader.read("test_csv_reader.csv", {"d", "e", "f"});
+  CHECK(strings(csv, "d") == std::vector<std::string>({"a", "1", "4", "7"}));
+  CHECK(csv.data->string_data(csv.column("d")) ==
+        std::vector<std::string>({"1", "4", "7", "a"}));
+
+  write_file("test_csv_reader.csv", "a\tb\n1\t2\n3\n");
+  reader.set_delim('\t');
+  CHECK_THROWS_AS(reader.read("test_csv_reader.csv"), Exception);
+  CHECK_THROWS_AS(reader.read("test_csv_reader_missing.csv"), Exception);
+  std::remove("test_csv_reader.csv");
+
+  const std::string buffer = "x;y\n1;2\n3;4\n";
+  reader.set_delim(';');
+  csv = reader.parse(buffer.data(), buffer.data() + buffer.size());
+  CHECK(numbers(csv, "x") == std::vector<double>({1, 3}));
+  CHECK(numbers(csv, "y") == std::vector<double>({2, 4}));
+}
+
+TEST_CASE("csv number parsing", "[csv reader]") {
+  // the first number is the offset of the column (see Column), so keep it 0
+  const std::string buffer = "x\n0\n1e3\n-2.5E-2\n 3 \n+4\n.5\n"
+                             "1234567890123456789012\n1e-30\n";
+  CSVReader reader;
+  auto csv = reader.parse(buffer.data(), buffer.data() + buffer.size());
+  auto x = numbers(csv, "x");
+  REQUIRE(x.size() == 8);
+  CHECK(x[0] == 0.0);
+  CHECK(x[1] == 1000.0);
+  CHECK(x[2] == Approx(-2.5e-2));
+  CHECK(x[3] == 3.0);
+  CHECK(x[4] == 4.0);
+  CHECK(x[5] == 0.5);
+  CHECK(x[6] == Approx(1234567890123456789012.0));
+  CHECK(x[7] == Approx(1e-30));
+
+  for (const std::string field : {"1e", "-", ".", "1.2.3", "0x10", "nan"}) {
+    const std::string text = "x\n1\n" + field + "\n";
+    csv = reader.parse(text.data(), text.data() + text.size());
+    CHECK(strings(csv, "x") == std::vector<std::string>({"1", field}));
+  }
+}
+
+TEST_CASE("read csv file in parallel", "[csv reader]") {
+  // long enough to be split into several chunks, with fields that straddle
+  // the 16 byte blocks scanned for delimiters. The last row turns the mixed
+  // column into strings after the other chunks parsed it as numbers
+  const size_t n = 50000;
+  std::string contents = "index,name,value,mixed\n";
+  for (size_t i = 0; i < n; ++i) {
+    contents += std::to_string(i) + ",name_of_row_" + std::to_string(i % 7) +
+                "," + std::to_string(i * 0.5) + "," +
+                (i + 1 < n ? std::to_string(i % 10) : "ten") + "\n";
+  }
+  write_file("test_csv_reader_parallel.csv", contents);
+
+  CSVReader reader;
+  reader.set_threads(1);
+  const auto serial = reader.read("test_csv_reader_parallel.csv");
+  reader.set_threads(8);
+  const auto parallel = reader.read("test_csv_reader_parallel.csv");
+  std::remove("test_csv_reader_parallel.csv");
+
+  REQUIRE(parallel.data->rows() == n);
+  CHECK(numbers(serial, "index") == numbers(parallel, "index"));
+  CHECK(strings(serial, "name") == strings(parallel, "name"));
+  CHECK(numbers(serial, "value") == numbers(parallel, "value"));
+  CHECK(strings(serial, "mixed") == strings(parallel, "mixed"));
+
+  const auto index = numbers(parallel, "index");
+  bool in_order = true;
+  for (size_t i = 0; i < n; ++i) {
+    in_order &= index[i] == static_cast<double>(i);
+  }
+  CHECK(in_order);
+  CHECK(strings(parallel, "name")[n - 1] ==
+        "name_of_row_" + std::to_string((n - 1) % 7));
+  CHECK(numbers(parallel, "value")[3] == 1.5);
+  CHECK(parallel.data->string_data(parallel.column("name")).size() == 7);
+  CHECK(parallel.data->string_data(parallel.column("mixed")).size() == 11);
+  CHECK(strings(parallel, "mixed")[12] == "2");
+  CHECK(strings(parallel, "mixed")[n - 1] == "ten");
+}
+
+TEST_CASE("parse csv stream", "[csv reader]") {
+  const std::string contents = "a,b,c\r\n"
+                               "1,2.5,x\r\n"
+                               "\n"
+                               "4,,y\r\n"
+                               "7,8,x";
+  CSVReader reader;
+  const auto expected =
+      reader.parse(contents.data(), contents.data() + contents.size());
+
+  // split the file into pieces of every size, so that lines, fields and line
+  // endings are split between writes
+  for (size_t n = 1; n <= contents.size(); ++n) {
+    auto stream = reader.stream();
+    for (size_t i = 0; i < contents.size(); i += n) {
+      stream.write(contents.data() + i, std::min(n, contents.size() - i));
+    }
+    const auto csv = stream.finish();
+    CHECK(csv.names == expected.names);
+    CHECK(numbers(csv, "a") == numbers(expected, "a"));
+    CHECK(numbers(csv, "b")[2] == numbers(expected, "b")[2]);
+    CHECK(strings(csv, "c") == strings(expected, "c"));
+  }
+
+  // a column that turns out to hold strings keeps the text of its earlier
+  // numbers, as when parsing the whole buffer
+  auto stream = reader.stream({"x", "y"});
+  stream.write("1.50,1\n0.1,2\n,3\n", 16);
+  stream.write("abc,4", 5);
+  auto csv = stream.finish();
+  CHECK(strings(csv, "x") ==
+        std::vector<std::string>({"1.50", "0.1", "", "abc"}));
+  CHECK(numbers(csv, "y") == std::vector<double>({1, 2, 3, 4}));
+
+  // only the text that cannot be written again from the numbers is kept
+  const std::string mixed = "id\n00123\n1.50\n0.1234567891\n1e3\n-0\n"
+                            "1000000\n-2.5\n123456.7\n0.001\n16777217\n"
+                            "1600000000123\nabc\n";
+  const auto parsed = reader.parse(mixed.data(), mixed.data() + mixed.size());
+  CHECK(strings(parsed, "id") ==
+        std::vector<std::string>({"00123", "1.50", "0.1234567891", "1e3", "-0",
+                                  "1000000", "-2.5", "123456.7", "0.001",
+                                  "16777217", "1600000000123", "abc"}));
+  for (size_t n = 1; n <= mixed.size(); ++n) {
+    stream = reader.stream();
+    for (size_t i = 0; i < mixed.size(); i += n) {
+      stream.write(mixed.data() + i, std::min(n, mixed.size() - i));
+    }
+    csv = stream.finish();
+    CHECK(strings(csv, "id") == strings(parsed, "id"));
+  }
+
+  stream = reader.stream();
+  stream.write("x,y\n1,2\n", 8);
+  CHECK_THROWS_AS(stream.write("3\n", 2), Exception);
+}
+
+TEST_CASE("read some columns and rows of a csv file", "[csv reader]") {
+  const std::string contents = "a,b,c,d\n"
+                               "1,x,2.5,p\n"
+                               "2,y,3.5,q\n"
+                               "3,x,4.5,r\n"
+                               "4,y,5.5,s\n";
+  const char *begin = contents.data();
+  const char *end = begin + contents.size();
+
+  CSVReader reader;
+  reader.set_columns({"c", "a"});
+  auto csv = reader.parse(begin, end);
+  CHECK(csv.names == std::vector<std::string>({"c", "a"}));
+  CHECK(csv.data->cols() == 2);
+  CHECK(numbers(csv, "c") == std::vector<double>({2.5, 3.5, 4.5, 5.5}));
+  CHECK(numbers(csv, "a") == std::vector<double>({1, 2, 3, 4}));
+
+  // the fields after the last column read are not split, but are still
+  // counted (also in lines longer than the 16 bytes scanned at once)
+  const std::string wide = "a,b,c\n1,2,3\n4,five_and_a_long_field,6,,\n";
+  const std::string ragged = "a,b,c\n1,2,3\n4,5\n6,7,8,9\n";
+  reader.set_columns({"a"});
+  csv = reader.parse(wide.data(), wide.data() + wide.size() - 3);
+  CHECK(numbers(csv, "a") == std::vector<double>({1, 4}));
+  CHECK_THROWS_AS(reader.parse(wide.data(), wide.data() + wide.size()),
+                  Exception);
+  CHECK_THROWS_AS(reader.parse(ragged.data(), ragged.data() + ragged.size()),
+                  Exception);
+  reader.set_columns({"e"});
+  CHECK_THROWS_AS(reader.parse(begin, end), Exception);
+
+  // the filter can use any column, also those that are not read
+  reader.set_columns({"a", "d"});
+  reader.set_filter([](const CSVRow &row) {
+    return row.string("b") == "y" || row.number("c") < 3;
+  });
+  csv = reader.parse(begin, end);
+  CHECK(numbers(csv, "a") == std::vector<double>({1, 2, 4}));
+  CHECK(strings(csv, "d") == std::vector<std::string>({"p", "q", "s"}));
+
+  // or by the index of their label
+  const size_t b = 1;
+  const size_t c = 2;
+  reader.set_filter([](const CSVRow &row) {
+    return row.string(b) == "y" || row.number(c) < 3;
+  });
+  CHECK(numbers(reader.parse(begin, end), "a") ==
+        std::vector<double>({1, 2, 4}));
+
+  reader.set_max_rows(2);
+  csv = reader.parse(begin, end);
+  CHECK(numbers(csv, "a") == std::vector<double>({1, 2}));
+
+  reader.set_filter(nullptr);
+  reader.set_columns({});
+  reader.set_max_rows(3);
+  csv = reader.parse(begin, end);
+  CHECK(csv.names.size() == 4);
+  CHECK(strings(csv, "b") == std::vector<std::string>({"x", "y", "x"}));
+
+  // streams stop at the row limit
+  reader.set_columns({"b"});
+  auto stream = reader.stream();
+  stream.write(begin, 18);
+  CHECK(!stream.done());
+  stream.write(begin + 18, contents.size() - 18);
+  CHECK(stream.done());
+  csv = stream.finish();
+  CHECK(csv.names == std::vector<std::string>({"b"}));
+  CHECK(strings(csv, "b") == std::vector<std::string>({"x", "y", "x"}));
+}
+
+TEST_CASE("csv row fields", "[csv reader]") {
+  const std::vector<std::string> labels = {"a", "b", "c"};
+  const std::string line = "1.5,x,";
+  const char *p = line.data();
+  const std::vector<CSVRow::field_t> fields = {
+      {p, p + 3}, {p + 4, p + 5}, {p + 6, p + 6}};
+  const CSVRow row(labels, fields);
+
+  CHECK(row.index("a") == 0);
+  CHECK(row.index("c") == 2);
+  CHECK_THROWS_AS(row.index("d"), Exception);
+  CHECK(row.string(row.index("b")) == "x");
+  CHECK(row.string(1) == row.string("b"));
+  CHECK(row.number(0) == 1.5);
+  CHECK(std::isnan(row.number(1)));
+  CHECK(std::isnan(row.number(2)));
+  CHECK_THROWS_AS(row.string(3), std::out_of_range);
+  CHECK_THROWS_AS(row.number(3), std::out_of_range);
+}
+
+TEST_CASE("read some columns of a csv file in parallel", "[csv reader]") {
+  const size_t n = 50000;
+  std::string contents = "index,name,value\n";
+  for (size_t i = 0; i < n; ++i) {
+    contents += std::to_string(i) + ",name_of_row_" + std::to_string(i % 7) +
+                "," + std::to_string(i * 0.5) + "\n";
+  }
+  const char *begin = contents.data();
+  const char *end = begin + contents.size();
+
+  CSVReader reader;
+  reader.set_threads(8);
+  reader.set_columns({"value", "index"});
+  reader.set_filter(
+      [](const CSVRow &row) { return row.string("name") == "name_of_row_3"; });
+  const auto csv = reader.parse(begin, end);
+  const auto index = numbers(csv, "index");
+  const auto value = numbers(csv, "value");
+  REQUIRE(index.size() == (n + 3) / 7);
+  bool filtered = true;
+  for (size_t i = 0; i < index.size(); ++i) {
+    filtered &= index[i] == 7 * i + 3 && value[i] == 0.5 * index[i];
+  }
+  CHECK(filtered);
+}
+
@@ -33,6 +33,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "catch.hpp"
 
+#include <cmath>
 #include <limits>
 #include <type_traits>
 
@@ -143,6 +144,80 @@ TEST_CASE("add some rows to raw data", "[data]") {
   }
 }
 
+TEST_CASE("raw data columns are contiguous", "[data]") {
+  RawData data;
+  data.add_column(std::vector<float>({1, 2, 3}));
+  data.add_row(std::vector<float>({4}));
+  data.add_column(std::vector<int>({5, 6, 7, 8}));
+
+  CHECK(data.rows() == 4);
+  CHECK(data.cols() == 2);
+  for (size_t i = 0; i < data.cols(); ++i) {
+    CHECK(data.begin(i).is_contiguous());
+    CHECK(data.end(i) - data.begin(i) == 4);
+    CHECK(data.end(i).get() - data.begin(i).get() == 4);
+  }
+  CHECK(data.begin(0)[3] == 4);
+  CHECK(data.begin(1)[3] == 8);
+}
+
+TEST_CASE("borrowed columns in raw data", "[data]") {
+  // interleaved x/y buffer, owned by a shared_ptr
+  auto buffer = std::make_shared<std::vector<float>>(
+      std::vector<float>({1, 10, 2, 20, 3, 30}));
+
+  RawData data;
+  data.add_column(Column(buffer->data(), 3, 2, buffer));
+  data.add_column(Column(buffer->data() + 1, 3, 2, buffer));
+
+  CHECK(data.rows() == 3);
+  CHECK(data.cols() == 2);
+  CHECK(data.begin(0).get() == buffer->data());
+  CHECK(data.begin(1).get() == buffer->data() + 1);
+  CHECK(data.end(0) - data.begin(0) == 3);
+
+  // data is kept alive by the columns
+  std::weak_ptr<std::vector<float>> weak_buffer = buffer;
+  buffer.reset();
+  CHECK_FALSE(weak_buffer.expired());
+  CHECK(data.begin(0)[2] == 3);
+  CHECK(data.begin(1)[2] == 30);
+
+  // adding a row copies the borrowed data into owned buffers
+  data.add_row(std::vector<float>({4, 40}));
+  CHECK(data.begin(0).is_contiguous());
+  CHECK(weak_buffer.expired());
+  CHECK(data.begin(0)[3] == 4);
+  CHECK(data.begin(1)[2] == 30);
+
+  CHECK_THROWS_AS(data.add_column(Column(data.begin(0).get(), 3)), Exception);
+}
+
+TEST_CASE("raw data with more than 2^31 rows", "[data]") {
+  // a stride of 0 repeats a single value for every row, so this needs no
+  // storage
+  const float value = 2.f;
+  const size_t n = (size_t(1) << 31) + 3;
+  RawData data;
+  data.add_column(Column(&value, n, 0));
+  data.add_column(Column(&value, n, 0));
+
+  CHECK(data.rows() == n);
+  CHECK(data.cols() == 2);
+  CHECK(data.rows() * data.cols() > (size_t(1) << 32));
+
+  const auto begin = data.begin(1);
+  const auto end = data.end(1);
+  const auto last = static_cast<std::ptrdiff_t>(n) - 1;
+  CHECK(static_cast<size_t>(end - begin) == n);
+  CHECK(static_cast<size_t>(std::distance(begin, end)) == n);
+  CHECK(begin + last + 1 == end);
+  CHECK(begin + last != end);
+  CHECK(begin[last] == value);
+  CHECK(*(begin + last) == value);
+  CHECK((end - 1) - begin == last);
+}
+
 TEST_CASE("string data conversion", "[data]") {
   RawData data;
   std::vector<std::string> first_col = {"1", "2", "3"};
@@ -211,6 +286,180 @@ TEST_CASE("string data conversion", "[data]") {
   CHECK_THROWS_AS(data.set_column(0, bad_col), std::invalid_argument);
 }
 
+TEST_CASE("dictionary encoded string columns", "[data]") {
+  // many repeated categories, in no particular order
+  const size_t n = 1000;
+  const size_t categories = 100;
+  std::vector<std::string> hosts(n);
+  for (size_t i = 0; i < n; ++i) {
+    hosts[i] = "host" + std::to_string((i * 7919) % categories);
+  }
+
+  RawData data;
+  data.add_column(hosts);
+  const auto &dictionary = data.string_data(0);
+  CHECK(dictionary.size() == categories);
+  CHECK(std::is_sorted(dictionary.begin(), dictionary.end()));
+  for (size_t i = 0; i < n; ++i) {
+    const auto code = data.begin(0)[static_cast<std::ptrdiff_t>(i)];
+    REQUIRE(code == static_cast<float>(static_cast<size_t>(code)));
+    CHECK(dictionary[static_cast<size_t>(code)] == hosts[i]);
+  }
+
+  // numeric columns have an empty dictionary
+  data.set_column(0, std::vector<std::string>(n, "1.5"));
+  CHECK(data.string_data(0).empty());
+  CHECK(data.begin(0)[0] == 1.5f);
+}
+
+TEST_CASE("ring buffer raw data", "[data]") {
+  RawData data;
+  data.add_column(std::vector<float>({1, 2, 3, 4}));
+  data.add_column(std::vector<float>({4, 3, 2, 1}));
+  data.set_capacity(3);
+  CHECK(data.capacity() == 3);
+  CHECK(data.rows() == 3);
+  CHECK(std::vector<float>(data.begin(0), data.end(0)) ==
+        std::vector<float>({2, 3, 4}));
+
+  // appending to a full data set drops the oldest row without reallocating
+  const float *buffer = data.begin(0).get();
+  data.add_row(std::vector<float>({5, 0}));
+  CHECK(data.rows() == 3);
+  CHECK(std::vector<float>(data.begin(0), data.end(0)) ==
+        std::vector<float>({3, 4, 5}));
+  CHECK(std::vector<float>(data.begin(1), data.end(1)) ==
+        std::vector<float>({2, 1, 0}));
+  CHECK_FALSE(data.begin(0).is_contiguous());
+  CHECK((data.begin(0) + 2).get() == buffer);
+
+  data.add_rows(std::vector<float>({6, 10, 7, 11}));
+  CHECK(data.rows() == 3);
+  CHECK(std::vector<float>(data.begin(0), data.end(0)) ==
+        std::vector<float>({5, 6, 7}));
+  CHECK(data.minmax(1) == std::make_pair(0.f, 11.f));
+  CHECK_THROWS_AS(data.add_rows(std::vector<float>({1, 2, 3})), Exception);
+
+  // views of a ring buffer are unaffected by later appends
+  auto faceted = data.facet_view(std::vector<int>({0, 1, 0}));
+  data.add_row(std::vector<float>({8, 12}));
+  CHECK(std::vector<float>(faceted[0]->begin(0), faceted[0]->end(0)) ==
+        std::vector<float>({5, 7}));
+  CHECK(std::vector<float>(data.begin(0), data.end(0)) ==
+        std::vector<float>({6, 7, 8}));
+
+  // removing the capacity lets the data set grow again
+  data.set_capacity(0);
+  data.add_row(std::vector<float>({9, 13}));
+  CHECK(data.rows() == 4);
+  CHECK(data.begin(0).is_contiguous());
+}
+
+TEST_CASE("ring buffer limits", "[data]") {
+  auto data = create_data().x(std::vector<float>()).y(std::vector<float>());
+  data.set_capacity(100);
+
+  // a window over a noisy, increasing signal
+  std::vector<float> x, y;
+  for (int i = 0; i < 1000; ++i) {
+    const auto t = static_cast<float>(i);
+    const auto v = static_cast<float>((i * 37) % 101) + 0.01f * t;
+    x.push_back(t);
+    y.push_back(v);
+    data.add_row(std::vector<float>({t, v}));
+    if (i % 97 == 1 || i == 999) {
+      const size_t first = x.size() > 100 ? x.size() - 100 : 0;
+      const auto y_minmax = std::minmax_element(y.begin() + first, y.end());
+      CHECK(data.rows() == x.size() - first);
+      CHECK(data.limits().bmin[Aesthetic::x::index] == x[first]);
+      CHECK(data.limits().bmax[Aesthetic::x::index] == t);
+      CHECK(data.limits().bmin[Aesthetic::y::index] == *y_minmax.first);
+      CHECK(data.limits().bmax[Aesthetic::y::index] == *y_minmax.second);
+    }
+  }
+
+  // bulk append
+  data.add_rows(std::vector<float>({1000, -5, 1001, 500}));
+  CHECK(data.limits().bmin[Aesthetic::x::index] == 902);
+  CHECK(data.limits().bmax[Aesthetic::x::index] == 1001);
+  CHECK(data.limits().bmin[Aesthetic::y::index] == -5);
+  CHECK(data.limits().bmax[Aesthetic::y::index] == 500);
+
+  // missing values are ignored, unless the whole window is missing
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  Column column(std::vector<float>({2, 1}));
+  column.set_capacity(3);
+  column.push_back(nan);
+  CHECK(column.minmax() == std::make_pair(1.f, 2.f));
+  column.push_back(3.0);
+  CHECK(column.minmax() == std::make_pair(1.f, 3.f));
+  column.push_back(nan);
+  column.push_back(nan);
+  CHECK(column.minmax() == std::make_pair(3.f, 3.f));
+  column.push_back(nan);
+  CHECK(std::isnan(column.minmax().first));
+  column.push_back(-1.0);
+  CHECK(column.minmax() == std::make_pair(-1.f, -1.f));
+
+  // as they are when appending to a column that is not a ring buffer
+  Column missing(std::vector<float>({nan}));
+  CHECK(std::isnan(missing.minmax().first));
+  missing.push_back(4.0);
+  missing.push_back(nan);
+  CHECK(missing.minmax() == std::make_pair(4.f, 4.f));
+
+  // empty columns, and those of only NaN values, have a NaN min/max
+  CHECK(std::isnan(Column().minmax().first));
+  CHECK(std::isnan(Column::range(1.0, 2.0, 0).minmax().second));
+  CHECK(std::isnan(Column::range(1.0, 2.0, 0).decoded_minmax().first));
+  Column empty_ring;
+  empty_ring.set_capacity(3);
+  CHECK(std::isnan(empty_ring.minmax().first));
+  Column nans(std::vector<float>({nan, nan, nan}));
+  auto nan_rows = std::make_shared<std::vector<size_t>>(
+      std::initializer_list<size_t>{2, 0});
+  CHECK(std::isnan(nans.select(nan_rows).minmax().first));
+  CHECK(std::isnan(nans.minmax().second));
+}
+
+TEST_CASE("contiguous min/max", "[data]") {
+  std::vector<float> values(67);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = static_cast<float>((i * 29) % 67) - 30.f;
+  }
+
+  // all lengths and alignments, so both the SIMD and scalar parts are used
+  for (size_t begin = 0; begin < 9; ++begin) {
+    for (size_t end = begin + 1; end <= values.size(); ++end) {
+      const auto expected = std::minmax_element(values.data() + begin,
+                                                values.data() + end);
+      const auto result =
+          contiguous_minmax(values.data() + begin, values.data() + end);
+      CHECK(result.first == *expected.first);
+      CHECK(result.second == *expected.second);
+    }
+  }
+
+  // NaN values are ignored
+  values[20] = std::numeric_limits<float>::quiet_NaN();
+  values[35] = std::numeric_limits<float>::quiet_NaN();
+  const auto result =
+      contiguous_minmax(values.data(), values.data() + values.size());
+  CHECK(result.first == -30.f);
+  CHECK(result.second == 36.f);
+
+  // the min/max of a column is updated as it is appended to
+  Column column(std::vector<float>({1, 2, 3}));
+  CHECK(column.minmax() == std::make_pair(1.f, 3.f));
+  column.push_back(-1);
+  column.push_back(4);
+  CHECK(column.minmax() == std::make_pair(-1.f, 4.f));
+  Column copy(column);
+  copy.push_back(5);
+  CHECK(copy.minmax() == std::make_pair(-1.f, 5.f));
+  CHECK(column.minmax() == std::make_pair(-1.f, 4.f));
+}
+
 TEST_CASE("data faceting", "[data]") {
   RawData data;
   std::vector<float> first_col = {1, 2, 3, 4, 5, 6};
@@ -276,6 +525,149 @@ TEST_CASE("data dual faceting", "[data]") {
       "facet column 1 must have an identical number of rows to the dataset");
 }
 
+TEST_CASE("data faceting with many groups", "[data]") {
+  const size_t n = 1000;
+  const int groups = 37;
+  std::vector<float> x(n);
+  std::vector<int64_t> t(n);
+  std::vector<int> key(n);
+  std::vector<std::string> label(n);
+  for (size_t i = 0; i < n; ++i) {
+    x[i] = static_cast<float>(i);
+    t[i] = 1500000000000 + static_cast<int64_t>(i);
+    key[i] = static_cast<int>((i * 7919) % groups);
+    label[i] = key[i] % 2 ? "odd" : "even";
+  }
+  RawData data;
+  data.add_column(x);
+  data.add_column(Column::offset_encoded(t));
+
+  auto faceted = data.facet(key);
+  CHECK(faceted.size() == groups);
+  size_t total = 0;
+  for (auto &facet : faceted) {
+    auto &raw = *facet.second;
+    REQUIRE(raw.cols() == 2);
+    CHECK(raw.begin(1).offset() == data.begin(1).offset());
+    for (size_t i = 0; i < raw.rows(); ++i) {
+      const auto ii = static_cast<std::ptrdiff_t>(i);
+      const auto row = static_cast<size_t>(raw.begin(0)[ii]);
+      CHECK(key[row] == facet.first);
+      CHECK(raw.begin(1).decode(ii) == static_cast<double>(t[row]));
+      // rows within a facet keep their original order
+      if (i > 0) {
+        CHECK(raw.begin(0)[ii - 1] < raw.begin(0)[ii]);
+      }
+    }
+    total += raw.rows();
+  }
+  CHECK(total == n);
+
+  auto dual_faceted = data.facet(label, key);
+  CHECK(dual_faceted.size() == groups);
+  CHECK(dual_faceted.begin()->first.first == "even");
+  CHECK(dual_faceted.rbegin()->first.first == "odd");
+}
+
+TEST_CASE("data faceting views", "[data]") {
+  RawData data;
+  std::vector<float> first_col = {1, 2, 3, 4, 5, 6};
+  std::vector<float> second_col = {6, 5, 4, 3, 2, 1};
+  data.add_column(std::move(first_col));
+  data.add_column(std::move(second_col));
+
+  auto faceted = data.facet_view(std::vector<int>({3, 3, 1, 2, 1, 3}));
+  REQUIRE(faceted.size() == 3);
+  auto &facet = *faceted[3];
+  CHECK(facet.rows() == 3);
+  CHECK(facet.cols() == 2);
+  CHECK_FALSE(facet.begin(0).is_contiguous());
+  CHECK(std::vector<float>(facet.begin(0), facet.end(0)) ==
+        std::vector<float>({1, 2, 6}));
+  CHECK(std::vector<float>(facet.begin(1), facet.end(1)) ==
+        std::vector<float>({6, 5, 1}));
+
+  // the facet shares the buffers of the parent
+  CHECK((facet.begin(0) + 2).get() == (data.begin(0) + 5).get());
+
+  // a view of a view selects from the original buffer
+  auto nested = facet.facet_view(std::vector<int>({0, 1, 1}));
+  CHECK((nested[1]->begin(1) + 1).get() == (data.begin(1) + 5).get());
+
+  // adding a row to a view copies it, leaving the parent unchanged
+  facet.add_row(std::vector<float>({7, 0}));
+  CHECK(facet.rows() == 4);
+  CHECK(facet.begin(0)[3] == 7);
+  CHECK(data.rows() == 6);
+  CHECK(faceted[1]->begin(0)[1] == 5);
+
+  auto dual = data.facet_view(std::vector<int>({3, 2, 1, 2, 1, 3}),
+                              std::vector<int>({3, 3, 1, 2, 1, 3}));
+  CHECK(dual.size() == 4);
+  CHECK(dual[std::make_pair(2, 3)]->begin(1)[0] == 5);
+
+  // facets, viewed or copied, share the dictionaries of string columns
+  RawData labelled;
+  labelled.add_column(std::vector<std::string>({"b", "a", "b", "c"}));
+  labelled.add_column(std::vector<float>({1, 2, 3, 4}));
+  const std::vector<int> key = {0, 1, 1, 0};
+  for (auto &facets : {labelled.facet_view(key), labelled.facet(key)}) {
+    for (auto &i : facets) {
+      CHECK(&i.second->string_data(0) == &labelled.string_data(0));
+      CHECK(i.second->string_data(1).empty());
+    }
+    const auto &second = *facets.at(1);
+    CHECK(second.string_data(0)[second.begin(0)[0]] == "a");
+    CHECK(second.string_data(0)[second.begin(0)[1]] == "b");
+  }
+}
+
+TEST_CASE("filtered data views", "[data]") {
+  const size_t n = 1000;
+  std::vector<float> x(n), y(n);
+  std::vector<std::string> label(n);
+  for (size_t i = 0; i < n; ++i) {
+    x[i] = static_cast<float>(i);
+    y[i] = static_cast<float>(i % 7);
+    label[i] = i % 2 ? "odd" : "even";
+  }
+  auto data = create_data().x(x).y(y).color(label);
+
+  auto subset = data.filter<Aesthetic::x, Aesthetic::y>(
+      [](double x, double y) { return x >= 500 && y == 3; });
+  REQUIRE(subset.rows() == 72);
+  for (auto i = subset.begin<Aesthetic::y>(); i != subset.end<Aesthetic::y>();
+       ++i) {
+    CHECK(*i == 3.f);
+  }
+  CHECK(subset.begin<Aesthetic::x>()[0] == 500.f);
+
+  // the view shares the columns and dictionaries, and keeps the limits
+  CHECK((subset.begin<Aesthetic::x>() + 1).get() ==
+        data.begin<Aesthetic::x>().get() + 507);
+  CHECK((subset.limits().bmax == data.limits().bmax).all());
+  auto color = subset.begin<Aesthetic::color>();
+  CHECK(color[0] == 0.f);
+  CHECK(color[1] == 1.f);
+
+  // filter a view again, and select rows directly
+  auto odd = subset.filter<Aesthetic::color>(
+      [](double color) { return color == 1.0; });
+  CHECK(odd.rows() == 36);
+  CHECK(odd.begin<Aesthetic::x>()[0] == 507.f);
+
+  auto rows = std::make_shared<std::vector<size_t>>(
+      std::initializer_list<size_t>{2, 0});
+  auto selected = data.select(rows);
+  CHECK(selected.begin<Aesthetic::x>()[0] == 2.f);
+  CHECK(selected.begin<Aesthetic::x>()[1] == 0.f);
+  CHECK_THROWS_AS(
+      data.select(std::make_shared<std::vector<size_t>>(1, n)),
+      std::out_of_range);
+
+  CHECK(data.filter<Aesthetic::x>([](double) { return false; }).rows() == 0);
+}
+
 TEST_CASE("data faceting with aesthetics", "[data]") {
   DataWithAesthetic data;
   std::vector<float> x = {1, 2, 3, 4, 5, 6};
@@ -403,6 +795,413 @@ TEST_CASE("use data with aesthetics", "[data]") {
   }
 }
 
+TEST_CASE("use borrowed data with aesthetics", "[data]") {
+  std::vector<float> x = {1, 2, 3};
+  std::vector<float> y = {3, 2, 1};
+
+  auto data = create_data().x(Column(x.data(), x.size())).y(y);
+
+  CHECK(data.rows() == 3);
+  CHECK(data.begin<Aesthetic::x>().get() == x.data());
+  CHECK(data.begin<Aesthetic::y>().get() != y.data());
+  CHECK(data.limits().bmin[Aesthetic::x::index] == 1);
+  CHECK(data.limits().bmax[Aesthetic::x::index] == 3);
+
+  // overwrite x with a reversed view of y
+  data.x(Column(y.data() + 2, y.size(), -1));
+  CHECK(data.begin<Aesthetic::x>()[0] == 1);
+  CHECK(data.begin<Aesthetic::x>()[2] == 3);
+  CHECK(std::distance(data.begin<Aesthetic::x>(), data.end<Aesthetic::x>()) ==
+        3);
+  CHECK(data.limits().bmin[Aesthetic::x::index] == 1);
+  CHECK(data.limits().bmax[Aesthetic::x::index] == 3);
+}
+
+TEST_CASE("move data into aesthetics", "[data]") {
+  std::vector<float> x = {1, 2, 3};
+  std::vector<float> y = {3, 2, 1};
+  const float *x_buffer = x.data();
+  const float *y_buffer = y.data();
+
+  auto data = create_data().x(std::move(x)).y(y);
+
+  CHECK(data.begin<Aesthetic::x>().get() == x_buffer);
+  CHECK(data.begin<Aesthetic::y>().get() != y_buffer);
+  CHECK(data.limits().bmin[Aesthetic::x::index] == 1);
+  CHECK(data.limits().bmax[Aesthetic::x::index] == 3);
+
+  // overwrite existing column
+  data.x(std::move(y));
+  CHECK(data.begin<Aesthetic::x>().get() == y_buffer);
+  CHECK(data.begin<Aesthetic::x>()[0] == 3);
+
+  // non-float vectors are still copied
+  data.y(std::vector<int>({4, 5, 6}));
+  CHECK(data.begin<Aesthetic::y>()[2] == 6);
+
+  RawData raw;
+  std::vector<float> col = {4, 5};
+  const float *col_buffer = col.data();
+  raw.add_column(std::move(col));
+  CHECK(raw.begin(0).get() == col_buffer);
+  CHECK_THROWS_AS(raw.set_column(0, std::vector<float>({1})), Exception);
+}
+
+TEST_CASE("cached aesthetic columns", "[data]") {
+  auto raw = std::make_shared<RawData>();
+  DataWithAesthetic data(raw);
+  CHECK(!data.has<Aesthetic::x>());
+  CHECK_THROWS_AS(data.begin<Aesthetic::x>(), Exception);
+
+  data.x(std::vector<float>({1, 2, 3})).y(std::vector<float>({3, 2, 1}));
+  CHECK(data.has<Aesthetic::x>());
+  CHECK(data.has<Aesthetic::y>());
+  CHECK(!data.has<Aesthetic::color>());
+  CHECK(data.begin<Aesthetic::y>()[2] == 1);
+
+  // a copy shares the same raw data and sees changes made through the
+  // original, even after its iterators are cached
+  DataWithAesthetic other = data;
+  CHECK(other.begin<Aesthetic::x>().get() == raw->begin(0).get());
+
+  data.add_row(std::vector<float>({4, 0}));
+  CHECK(std::distance(other.begin<Aesthetic::x>(),
+                      other.end<Aesthetic::x>()) == 4);
+  CHECK(other.begin<Aesthetic::x>()[3] == 4);
+
+  data.y(std::vector<float>({5, 6, 7, 8}));
+  CHECK(data.begin<Aesthetic::y>()[0] == 5);
+  CHECK(raw->begin(1)[3] == 8);
+}
+
+TEST_CASE("column pool", "[data]") {
+  ColumnPool pool;
+  std::vector<float> x = {1, 2, 3};
+  Column a(x);
+  Column b(x);
+  Column c(std::vector<float>({3, 2, 1}));
+  REQUIRE(a.begin().get() != b.begin().get());
+  CHECK(a.same_values(b));
+  CHECK(!a.same_values(c));
+  CHECK(!a.same_values(Column(x, 1.0)));
+  CHECK(a.same_values(Column(x.data(), x.size())));
+  CHECK(c.same_values(Column(x.data() + 2, x.size(), -1)));
+
+  CHECK(pool.intern(a).begin().get() == a.begin().get());
+  CHECK(pool.intern(b).begin().get() == a.begin().get());
+  CHECK(pool.intern(c).begin().get() == c.begin().get());
+  CHECK(pool.size() == 2);
+
+  // borrowed columns are neither pooled nor replaced by an owned column
+  std::vector<float> borrowed_x = x;
+  Column borrowed(borrowed_x.data(), borrowed_x.size());
+  CHECK(pool.intern(borrowed).begin().get() == borrowed_x.data());
+  CHECK(pool.size() == 2);
+  std::vector<float> other_x = {7, 8, 9};
+  CHECK(pool.intern(Column(other_x.data(), other_x.size())).begin().get() ==
+        other_x.data());
+  CHECK(pool.intern(Column(other_x)).begin().get() != other_x.data());
+  CHECK(pool.size() == 3);
+
+  // interned data sets share buffers, but appending copies them
+  RawData raw1, raw2;
+  raw1.add_column(x);
+  raw2.add_column(x);
+  raw1.intern_columns(pool);
+  raw2.intern_columns(pool);
+  CHECK(raw1.begin(0).get() == a.begin().get());
+  CHECK(raw2.begin(0).get() == a.begin().get());
+  raw2.add_row(std::vector<float>({4}));
+  CHECK(raw2.begin(0).get() != a.begin().get());
+  CHECK(raw2.begin(0)[3] == 4);
+  CHECK(raw1.rows() == 3);
+  CHECK(a.size() == 3);
+
+  // copies of a data set (e.g. made by DataWithAesthetic::intern_columns())
+  // share its string dictionaries
+  raw1.add_column(std::vector<std::string>({"a", "b", "a"}));
+  RawData copy(raw1);
+  copy.intern_columns(pool);
+  CHECK(&copy.string_data(1)[0] == &raw1.string_data(1)[0]);
+  CHECK(copy.string_data(0).empty());
+}
+
+TEST_CASE("quantised columns", "[data]") {
+  const size_t n = 1000;
+  std::vector<float> x(n);
+  for (size_t i = 0; i < n; ++i) {
+    x[i] = 100.f + std::sin(0.1f * i);
+  }
+  Column column(x);
+  Column quantised = column.quantised();
+  CHECK(quantised.is_quantised());
+  CHECK(!quantised.is_borrowed());
+  CHECK(!quantised.begin().is_contiguous());
+  REQUIRE(quantised.size() == n);
+
+  // the min element is exact, the others are within half a step
+  const float step = 2.f / 65534.f;
+  const auto min_max = column.minmax();
+  CHECK(quantised.offset() == min_max.first);
+  CHECK(quantised.minmax().first == 0.f);
+  for (size_t i = 0; i < n; ++i) {
+    CHECK(std::abs(quantised.begin().decode(i) - x[i]) <= 0.51f * step);
+  }
+  CHECK(quantised.same_values(Column(x).quantised()));
+  CHECK(quantised.same_values(Column(quantised)));
+
+  // a constant column is exact
+  Column constant = Column(std::vector<float>(3, 2.f)).quantised();
+  CHECK(constant.begin().decode(2) == 2.0);
+
+  // NaN elements stay NaN, and do not affect the scale of the others
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const float inf = std::numeric_limits<float>::infinity();
+  Column missing =
+      Column(std::vector<float>({nan, 1.f, 3.f, inf, 2.f})).quantised();
+  CHECK(std::isnan(missing.begin()[0]));
+  CHECK(missing.begin().decode(1) == 1.0);
+  CHECK(missing.begin().decode(2) == Approx(3.0));
+  CHECK(std::isnan(missing.begin()[3]));
+  CHECK(missing.begin().decode(4) == Approx(2.0).margin(2.f / 65534.f));
+  Column all_missing = Column(std::vector<float>(3, nan)).quantised();
+  CHECK(all_missing.is_quantised());
+  CHECK(std::isnan(all_missing.begin()[1]));
+  CHECK(std::isfinite(all_missing.offset()));
+
+  // appending decodes the column back to floats
+  const float last = quantised.begin()[n - 1];
+  quantised.push_back(50.0);
+  CHECK(!quantised.is_quantised());
+  CHECK(quantised.begin().is_contiguous());
+  CHECK(quantised.begin()[n - 1] == last);
+  CHECK(quantised.begin().decode(n) == 50.0);
+
+  // string columns are left as is
+  std::vector<std::string> labels(n);
+  for (size_t i = 0; i < n; ++i) {
+    labels[i] = i % 2 ? "b" : "a";
+  }
+  RawData raw;
+  raw.add_column(x);
+  raw.add_column(labels);
+  raw.quantise();
+  CHECK(!raw.begin(0).is_contiguous());
+  CHECK(raw.begin(1).is_contiguous());
+  CHECK(raw.string_data(1)[raw.begin(1)[3]] == "b");
+}
+
+TEST_CASE("range columns", "[data]") {
+  const size_t n = 1000;
+  Column column = Column::range(10.0, -0.5, n);
+  CHECK(column.is_range());
+  CHECK(!column.is_borrowed());
+  CHECK(!column.begin().is_contiguous());
+  CHECK(column.size() == n);
+  CHECK(column.begin().decode(0) == 10.0);
+  CHECK(column.begin().decode(3) == 8.5);
+  CHECK(column.minmax().first == -0.5f * (n - 1));
+  CHECK(column.minmax().second == 0.f);
+  CHECK(column.quantised().is_range());
+
+  // ranges are calculated in double precision, past the 2^24 integers that
+  // a float holds exactly
+  const size_t m = (size_t(1) << 32) + 3;
+  Column large = Column::range(1e9, 0.25, m);
+  CHECK(large.begin().decode(16777217) == 1e9 + 0.25 * 16777217);
+  CHECK(large.begin().decode(m - 1) == 1e9 + 0.25 * (m - 1));
+  CHECK(large.decoded_minmax().first == 1e9);
+  CHECK(large.decoded_minmax().second == 1e9 + 0.25 * (m - 1));
+  Column steps = Column::range(0.0, 0.1, 16777219);
+  CHECK(steps.begin().decode(16777217) == 0.1 * 16777217);
+  CHECK(steps.decoded_minmax().second == 0.1 * 16777218);
+
+  std::vector<float> x(column.begin(), column.end());
+  CHECK(column.same_values(Column(x, 10.0)));
+
+  // views select rows of the range
+  auto rows = std::make_shared<std::vector<size_t>>(
+      std::initializer_list<size_t>{4, 2});
+  Column view = column.select(rows);
+  CHECK(view.begin().decode(0) == 8.0);
+  CHECK(view.minmax().first == -2.f);
+
+  // appending stores the column
+  column.push_back(-500.0);
+  CHECK(!column.is_range());
+  CHECK(column.begin().is_contiguous());
+  CHECK(column.begin().decode(n - 1) == 10.0 - 0.5 * (n - 1));
+  CHECK(column.begin().decode(n) == -500.0);
+
+  auto data = create_data()
+                  .x(Column::range(0.0, 2.0, 3))
+                  .y(std::vector<float>({1, 2, 3}));
+  CHECK(data.limits().bmin[Aesthetic::x::index] == 0.f);
+  CHECK(data.limits().bmax[Aesthetic::x::index] == 4.f);
+  data.add_row(std::vector<float>({6, 4}));
+  CHECK(data.begin<Aesthetic::x>()[3] == 6.f);
+}
+
+TEST_CASE("column statistics", "[data]") {
+  Column column(std::vector<float>({1, 2, 2, 5}));
+  CHECK(column.is_sorted());
+  CHECK(column.distinct() == 3);
+
+  // appending keeps the cached statistics up to date
+  column.push_back(5.0);
+  CHECK(column.is_sorted());
+  CHECK(column.distinct() == 3);
+  column.push_back(7.0);
+  CHECK(column.distinct() == 4);
+  column.push_back(0.0);
+  CHECK(!column.is_sorted());
+  CHECK(column.distinct() == 5);
+  column.push_back(8.0);
+  CHECK(!column.is_sorted());
+
+  // dropping the oldest element of a ring buffer can sort the column
+  column.set_capacity(3);
+  CHECK(!column.is_sorted());
+  column.push_back(9.0);
+  CHECK(column.is_sorted());
+  CHECK(column.distinct() == 3);
+  column.push_back(9.0);
+  CHECK(column.distinct() == 2);
+  column.push_back(1.0);
+  CHECK(!column.is_sorted());
+
+  CHECK(Column::range(0.0, 1.0, 100).is_sorted());
+  CHECK(Column::range(0.0, 1.0, 100).distinct() == 100);
+  CHECK(!Column::range(0.0, -1.0, 100).is_sorted());
+  CHECK(Column::range(3.0, 0.0, 100).distinct() == 1);
+  auto rows = std::make_shared<std::vector<size_t>>(
+      std::initializer_list<size_t>{4, 2, 2});
+  CHECK(!Column::range(0.0, 1.0, 100).select(rows).is_sorted());
+  CHECK(Column::range(0.0, 1.0, 100).select(rows).distinct() == 2);
+
+  auto data = create_data()
+                  .x(std::vector<float>({3, 1, 2, 1}))
+                  .y(std::vector<float>({0, 1, 1, 2}));
+  CHECK(!data.is_sorted<Aesthetic::x>());
+  CHECK(data.distinct<Aesthetic::x>() == 3);
+  CHECK(data.is_sorted<Aesthetic::y>());
+  CHECK(data.distinct<Aesthetic::y>() == 3);
+  CHECK(data.minmax<Aesthetic::x>().first == 1.f);
+  CHECK(data.minmax<Aesthetic::x>().second == 3.f);
+
+  RawData raw;
+  raw.add_column(std::vector<float>({3, 1, 2, 1}));
+  raw.add_column(std::vector<float>({0, 1, 1, 2}));
+  CHECK(raw.is_sorted(1));
+  CHECK(raw.distinct(0) == 3);
+  CHECK_THROWS_AS(raw.is_sorted(5), std::out_of_range);
+}
+
+TEST_CASE("offset encoded columns", "[data]") {
+  // a month of epoch millisecond timestamps, one minute apart. Stored
+  // directly as floats these would round to multiples of 131072 ms
+  const int64_t t0 = 1500000000000;
+  const int64_t minute = 60 * 1000;
+  const int64_t month = 30 * 24 * 60 * minute;
+  std::vector<int64_t> t = {t0 + month, t0, t0 + minute, t0 + 2 * minute};
+
+  auto column = Column::offset_encoded(t);
+  CHECK(column.size() == 4);
+  CHECK(column.offset() == static_cast<double>(t0));
+  for (size_t i = 0; i < t.size(); ++i) {
+    CHECK(column.begin().decode(static_cast<std::ptrdiff_t>(i)) ==
+          static_cast<double>(t[i]));
+  }
+  CHECK(Column::offset_encoded(std::vector<double>()).size() == 0);
+
+  // push_back encodes using the offset
+  RawData raw;
+  raw.add_column(column);
+  raw.add_row(std::vector<double>({static_cast<double>(t0 + 3 * minute)}));
+  CHECK(raw.rows() == 5);
+  CHECK(raw.begin(0).decode(4) == static_cast<double>(t0 + 3 * minute));
+  CHECK(column.size() == 4);
+
+  // the decoded values can be used as facet keys
+  const auto decoded = raw.decoded(0);
+  CHECK(decoded.size() == 5);
+  CHECK(decoded[1] == static_cast<double>(t0));
+  CHECK(decoded[4] == static_cast<double>(t0 + 3 * minute));
+  CHECK(raw.facet(decoded).count(static_cast<double>(t0 + minute)) == 1);
+  CHECK_THROWS_AS(raw.decoded(1), std::out_of_range);
+
+  auto data = create_data().x(column).y(std::vector<float>({0, 1, 2, 3}));
+  auto &limits = data.limits();
+  CHECK(limits.bmin[Aesthetic::x::index] == static_cast<double>(t0));
+  CHECK(limits.bmax[Aesthetic::x::index] == static_cast<double>(t0 + month));
+
+  // adjacent timestamps map to distinct, ordered display positions
+  bfloat2_t display({0.f, 0.f}, {1000.f, 1000.f});
+  auto x = data.begin<Aesthetic::x>();
+  const float x1 = Aesthetic::x::to_display(x.decode(1), limits, display);
+  const float x2 = Aesthetic::x::to_display(x.decode(2), limits, display);
+  const float x3 = Aesthetic::x::to_display(x.decode(3), limits, display);
+  CHECK(x1 < x2);
+  CHECK(x2 < x3);
+  CHECK(x3 - x2 == Approx(x2 - x1).epsilon(0.01));
+
+  // double data is offset encoded too
+  std::vector<double> seconds = {1.5e9 + 0.25, 1.5e9 + 0.5, 1.5e9};
+  auto seconds_column = Column::offset_encoded(seconds);
+  CHECK(seconds_column.begin().decode(0) == seconds[0]);
+  CHECK(seconds_column.begin().decode(1) == seconds[1]);
+  CHECK(seconds_column.begin()[2] == 0.f);
+}
+
+TEST_CASE("epoch millisecond windows shorter than a minute", "[data]") {
+  const int64_t t0 = 1600000000000;
+  bfloat2_t display({0.f, 0.f}, {1000.f, 1000.f});
+  std::vector<float> out(60);
+
+  // 60 samples one second apart span the whole axis
+  std::vector<int64_t> t(60);
+  for (size_t i = 0; i < t.size(); ++i) {
+    t[i] = t0 + 1000 * static_cast<int64_t>(i);
+  }
+  auto data = create_data().x(Column::offset_encoded(t));
+  auto &limits = data.limits();
+  CHECK(limits.bmin[Aesthetic::x::index] == static_cast<double>(t0));
+  CHECK(limits.bmax[Aesthetic::x::index] == static_cast<double>(t.back()));
+  auto x = data.begin<Aesthetic::x>();
+  CHECK(Aesthetic::x::to_display(x.decode(0), limits, display) ==
+        Approx(0.f).margin(1e-3));
+  CHECK(Aesthetic::x::to_display(x.decode(59), limits, display) ==
+        Approx(1000.f));
+  Aesthetic::x::map(limits, display)
+      .transform(x, data.end<Aesthetic::x>(), out.data());
+  for (size_t i = 0; i < out.size(); ++i) {
+    CHECK(out[i] == Approx(1000.f * i / 59.f).margin(1e-3));
+  }
+
+  // samples 100 ms apart, well below the float spacing at this magnitude
+  std::vector<int64_t> fast = {t0 + 200, t0, t0 + 100};
+  auto fast_data = create_data().x(Column::offset_encoded(fast));
+  auto fast_x = fast_data.begin<Aesthetic::x>();
+  CHECK(Aesthetic::x::to_display(fast_x.decode(0), fast_data.limits(),
+                                 display) == Approx(1000.f));
+  CHECK(Aesthetic::x::to_display(fast_x.decode(1), fast_data.limits(),
+                                 display) == Approx(0.f).margin(1e-3));
+  CHECK(Aesthetic::x::to_display(fast_x.decode(2), fast_data.limits(),
+                                 display) == Approx(500.f));
+
+  // equal samples at this magnitude still spread
+  // their equal limits to a finite, non-zero width
+  std::vector<int64_t> same = {t0 + 100, t0 + 100, t0 + 100};
+  auto equal = create_data().x(Column::offset_encoded(same));
+  auto &equal_limits = equal.limits();
+  CHECK(equal_limits.bmin[Aesthetic::x::index] <
+        equal_limits.bmax[Aesthetic::x::index]);
+  const float middle = Aesthetic::x::to_display(
+      equal.begin<Aesthetic::x>().decode(0), equal_limits, display);
+  CHECK(std::isfinite(middle));
+  CHECK(middle == Approx(500.f));
+}
+
 TEST_CASE("aesthetics", "[data]") {
   // x/y lims = 0->100
   // color lims = 100->200
@@ -483,6 +1282,91 @@ TEST_CASE("aesthetics", "[data]") {
   CHECK(ymax_data_check == ymax_data);
 }
 
+TEST_CASE("batch aesthetic transforms", "[data]") {
+  Limits lim({-10, 1000, 100, 1, 2}, {10, 1010, 200, 2, 3});
+  bfloat2_t pixels({0, 0}, {200, 100});
+
+  const size_t n = 37;
+  std::vector<float> x(n), y(n);
+  for (size_t i = 0; i < n; ++i) {
+    x[i] = -10.f + 20.f * static_cast<float>(i) / (n - 1);
+    y[i] = 1000.f + 10.f * static_cast<float>((i * 7) % n) / (n - 1);
+  }
+  auto data = create_data().x(x).y(y);
+  std::vector<float> out(n);
+
+  // contiguous columns
+  const auto to_x = Aesthetic::x::map(lim, pixels);
+  to_x.transform(data.begin<Aesthetic::x>(), data.end<Aesthetic::x>(),
+                 out.data());
+  for (size_t i = 0; i < n; ++i) {
+    CHECK(out[i] == Approx(Aesthetic::x::to_display(x[i], lim, pixels)));
+    CHECK(out[i] == Approx(10.f * (x[i] + 10.f)));
+  }
+  const auto to_y = Aesthetic::y::map(lim, pixels);
+  to_y.transform(data.begin<Aesthetic::y>(), data.end<Aesthetic::y>(),
+                 out.data());
+  for (size_t i = 0; i < n; ++i) {
+    CHECK(out[i] == Approx(Aesthetic::y::to_display(y[i], lim, pixels)));
+    CHECK(out[i] == Approx(10.f * (1010.f - y[i])).margin(1e-4));
+  }
+
+  // strided column
+  to_x.transform(Column(x.data(), n / 2, 2).begin(),
+                 Column(x.data(), n / 2, 2).end(), out.data());
+  for (size_t i = 0; i < n / 2; ++i) {
+    CHECK(out[i] == Approx(to_x(x[2 * i])));
+  }
+
+  // offset encoded column, adjacent millisecond timestamps are distinct
+  std::vector<int64_t> t(n);
+  for (size_t i = 0; i < n; ++i) {
+    t[i] = 1500000000000 + static_cast<int64_t>(i);
+  }
+  auto time = Column::offset_encoded(t);
+  Limits time_lim;
+  time_lim.bmin[Aesthetic::x::index] = static_cast<double>(t.front());
+  time_lim.bmax[Aesthetic::x::index] = static_cast<double>(t.front() + 1000000);
+  const auto to_time = Aesthetic::x::map(time_lim, pixels);
+  to_time.transform(time.begin(), time.end(), out.data());
+  for (size_t i = 0; i < n; ++i) {
+    CHECK(out[i] == Approx(to_time(time.begin().decode(i))).margin(1e-3));
+  }
+  CHECK(out[1] > out[0]);
+}
+
+TEST_CASE("data builder", "[data]") {
+  std::vector<int> x = {1, 2, 3};
+  std::vector<float> y = {3, 2, 1};
+  std::vector<std::string> color = {"b", "a", "b"};
+  std::vector<float> size = {5, 6, 7};
+  const float *size_buffer = size.data();
+
+  DataBuilder builder;
+  auto data = builder.x(x).y(y).color(color).size(std::move(size)).build();
+  auto chained = create_data().x(x).y(y).color(color).size(
+      std::vector<float>({5, 6, 7}));
+
+  CHECK(data.rows() == 3);
+  CHECK(data.cols() == 4);
+  CHECK(data.has<Aesthetic::color>());
+  CHECK(!data.has<Aesthetic::fill>());
+  CHECK(data.begin<Aesthetic::size>().get() == size_buffer);
+  CHECK(data.begin<Aesthetic::x>()[2] == 3.f);
+  CHECK(data.begin<Aesthetic::color>()[1] == 0.f);
+  CHECK((data.limits().bmin == chained.limits().bmin).all());
+  CHECK((data.limits().bmax == chained.limits().bmax).all());
+
+  // the builder is reset and can be reused
+  auto y_only = builder.y(std::vector<float>({1, 2})).build();
+  CHECK(y_only.cols() == 1);
+  CHECK(!y_only.has<Aesthetic::x>());
+
+  CHECK_THROWS_WITH(
+      builder.x(x).y(std::vector<float>({1, 2})).build(),
+      Catch::Contains("columns in dataset must have identical number of rows"));
+}
+
 TEST_CASE("test set limits", "[data]") {
 
   DataWithAesthetic data;
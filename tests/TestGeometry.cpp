@@ -37,6 +37,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <limits>
 #include <type_traits>
 
+#include "DummyDraw.hpp"
 #include "trase.hpp"
 
 using namespace trase;
@@ -67,3 +68,85 @@ TEST_CASE("line geometry can be created", "[geometry]") {
   auto data = create_data().x(x).y(y);
   auto pl5 = ax->line(data);
 }
+
+TEST_CASE("animation frames share identical columns", "[geometry]") {
+  auto fig = figure();
+  auto ax = fig->axis();
+  std::vector<float> x = {0.0f, 0.1f, 0.5f};
+  std::vector<float> y = {0.0f, 0.1f, 0.5f};
+  auto data = create_data().x(x).y(y);
+  auto plt = ax->points(data);
+  for (int i = 1; i < 5; ++i) {
+    y[0] = static_cast<float>(i);
+    plt->add_frame(create_data().x(x).y(y), static_cast<float>(i));
+  }
+
+  REQUIRE(plt->data_size() == 5);
+  for (size_t i = 1; i < plt->data_size(); ++i) {
+    CHECK(plt->get_data(i).begin<Aesthetic::x>().get() ==
+          plt->get_data(0).begin<Aesthetic::x>().get());
+    CHECK(plt->get_data(i).begin<Aesthetic::y>().get() !=
+          plt->get_data(0).begin<Aesthetic::y>().get());
+    CHECK(plt->get_data(i).begin<Aesthetic::y>()[0] == i);
+  }
+
+  // modifying a frame does not change the other frames, or the data set
+  // passed in
+  plt->get_data(0).add_row(std::vector<float>({1.f, 1.f}));
+  CHECK(plt->get_data(0).rows() == 4);
+  CHECK(plt->get_data(1).rows() == 3);
+  CHECK(data.rows() == 3);
+  CHECK(plt->get_data(1).begin<Aesthetic::x>().get() ==
+        data.begin<Aesthetic::x>().get());
+}
+
+TEST_CASE("live data sets are not copied by frames", "[geometry]") {
+  auto fig = figure();
+  auto ax = fig->axis();
+  std::vector<float> x = {0.0f, 0.1f, 0.5f};
+
+  // a single frame still points to the data set, so sees rows added to it
+  auto data = create_data().x(x).y(x);
+  auto plt = ax->points(data);
+  data.add_row(std::vector<float>({1.f, 1.f}));
+  CHECK(plt->get_data(0).rows() == 4);
+
+  // ring buffers are never interned, even when there are several frames
+  auto ring = create_data().x(x).y(x);
+  ring.set_capacity(3);
+  auto ring_plt = ax->points(ring);
+  ring_plt->add_frame(create_data().x(x).y(x), 1.f);
+  ring.add_row(std::vector<float>({1.f, 1.f}));
+  CHECK(ring_plt->get_data(0).begin<Aesthetic::x>().decode(2) == 1.0);
+
+  // as are data sets with borrowed columns
+  auto borrowed = create_data().x(Column(x.data(), x.size())).y(x);
+  auto borrowed_plt = ax->points(borrowed);
+  borrowed_plt->add_frame(create_data().x(x).y(x), 1.f);
+  CHECK(borrowed_plt->get_data(0).begin<Aesthetic::x>().get() == x.data());
+}
+
+TEST_CASE("quantised animation frames", "[geometry]") {
+  auto fig = figure();
+  auto ax = fig->axis();
+  std::vector<float> x = {0.0f, 0.1f, 0.5f};
+  std::vector<float> y = {0.0f, 0.1f, 0.5f};
+  auto plt = ax->points(create_data().x(x).y(y));
+  plt->set_quantised_frames(true);
+  for (int i = 1; i < 5; ++i) {
+    y[0] = static_cast<float>(i);
+    plt->add_frame(create_data().x(x).y(y), static_cast<float>(i));
+  }
+
+  REQUIRE(plt->data_size() == 5);
+  for (size_t i = 0; i < plt->data_size(); ++i) {
+    const auto &data = plt->get_data(i);
+    CHECK(!data.begin<Aesthetic::x>().is_contiguous());
+    CHECK(data.begin<Aesthetic::x>().decode(1) == Approx(0.1f).margin(1e-5));
+    CHECK(data.begin<Aesthetic::y>().decode(0) == Approx(i).margin(1e-4));
+  }
+
+  CHECK(plt->get_data(1).limits().bmax[Aesthetic::y::index] ==
+        Approx(1.f).margin(1e-4));
+  DummyDraw::draw("quantised_points", fig);
+}
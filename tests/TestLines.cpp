@@ -71,6 +71,24 @@ TEST_CASE("Lines creation", "[lines]") {
   DummyDraw::draw("lines", fig);
 }
 
+TEST_CASE("Lines with a range column", "[lines]") {
+  auto fig = figure();
+  auto ax = fig->axis();
+
+  // a uniformly sampled signal, the sample times are not stored
+  const int n = 100;
+  std::vector<float> y(n);
+  for (int i = 0; i < n; ++i) {
+    y[i] = std::sin(0.1f * i);
+  }
+  auto plt = ax->line(create_data().x(Column::range(-6.0, 0.12, n)).y(y));
+  CHECK(plt->get_data(0).limits().bmin[Aesthetic::x::index] == -6.f);
+  CHECK(plt->get_data(0).limits().bmax[Aesthetic::x::index] ==
+        Approx(-6.f + 0.12f * (n - 1)));
+
+  DummyDraw::draw("range_lines", fig);
+}
+
 TEST_CASE("Hybrids lines creation", "[lines]") {
 
   auto fig = figure();
@@ -0,0 +1,238 @@
+/*
+Copyright (c) 2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of the Oxford RSE C++ Template project.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "catch.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "trase.hpp"
+
+using namespace trase;
+
+namespace {
+
+template <typename T> std::string to_bytes(const std::vector<T> &values) {
+  return std::string(reinterpret_cast<const char *>(values.data()),
+                     values.size() * sizeof(T));
+}
+
+std::string little_endian(const uint64_t value, const size_t n) {
+  std::string bytes;
+  for (size_t i = 0; i < n; ++i) {
+    bytes += static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+  return bytes;
+}
+
+// the contents of a version 1.0 npy file
+std::string npy(const std::string &descr, const std::string &shape,
+                const std::string &body, const bool fortran_order = false) {
+  std::string header = "{'descr': " + descr + ", 'fortran_order': " +
+                       (fortran_order ? "True" : "False") +
+                       ", 'shape': " + shape + ", }";
+  header.append((64 - (header.size() + 11) % 64) % 64, ' ');
+  header += '\n';
+  return std::string("\x93NUMPY\x01\x00", 8) +
+         little_endian(static_cast<uint32_t>(header.size()), 2) + header +
+         body;
+}
+
+// the contents of an uncompressed zip file (i.e. a npz file). If @p zip64
+// is true the sizes, offsets and number of entries are given in zip64 form
+// (as written by numpy for large arrays)
+std::string zip(const std::vector<std::pair<std::string, std::string>> &files,
+                const uint16_t method = 0, const bool zip64 = false) {
+  const uint32_t unknown = 0xffffffff;
+  std::string local, central;
+  for (const auto &file : files) {
+    const uint64_t size = file.second.size();
+    const std::string sizes =
+        little_endian(0, 4) + little_endian(zip64 ? unknown : size, 4) +
+        little_endian(zip64 ? unknown : size, 4);
+    const std::string extra =
+        zip64 ? little_endian(1, 2) + little_endian(24, 2) +
+                    little_endian(size, 8) + little_endian(size, 8) +
+                    little_endian(local.size(), 8)
+              : "";
+    central += little_endian(0x02014b50, 4) + little_endian(45, 2) +
+               little_endian(45, 2) + little_endian(0, 2) +
+               little_endian(method, 2) + little_endian(0, 4) + sizes +
+               little_endian(file.first.size(), 2) +
+               little_endian(extra.size(), 2) + little_endian(0, 4) +
+               little_endian(0, 6) +
+               little_endian(zip64 ? unknown : local.size(), 4) + file.first +
+               extra;
+    const std::string local_extra =
+        zip64 ? little_endian(1, 2) + little_endian(16, 2) +
+                    little_endian(size, 8) + little_endian(size, 8)
+              : "";
+    local += little_endian(0x04034b50, 4) + little_endian(45, 2) +
+             little_endian(0, 2) + little_endian(method, 2) +
+             little_endian(0, 4) + sizes +
+             little_endian(file.first.size(), 2) +
+             little_endian(local_extra.size(), 2) + file.first + local_extra +
+             file.second;
+  }
+  std::string end;
+  if (zip64) {
+    const uint64_t record = local.size() + central.size();
+    end = little_endian(0x06064b50, 4) + little_endian(44, 8) +
+          little_endian(45, 2) + little_endian(45, 2) + little_endian(0, 8) +
+          little_endian(files.size(), 8) + little_endian(files.size(), 8) +
+          little_endian(central.size(), 8) + little_endian(local.size(), 8) +
+          little_endian(0x07064b50, 4) + little_endian(0, 4) +
+          little_endian(record, 8) + little_endian(1, 4);
+  }
+  const uint64_t entries = zip64 ? 0xffff : files.size();
+  return local + central + end + little_endian(0x06054b50, 4) +
+         little_endian(0, 4) + little_endian(entries, 2) +
+         little_endian(entries, 2) +
+         little_endian(zip64 ? unknown : central.size(), 4) +
+         little_endian(zip64 ? unknown : local.size(), 4) +
+         little_endian(0, 2);
+}
+
+void write_file(const std::string &filename, const std::string &contents) {
+  std::ofstream out(filename, std::ios::binary);
+  out << contents;
+}
+
+} // namespace
+
+TEST_CASE("load 1D and 2D npy files", "[npy]") {
+  write_file("test_npy_1d.npy",
+             npy("'<f4'", "(3,)", to_bytes(std::vector<float>{1, 5, 2})));
+  auto npy1 = load_npy("test_npy_1d.npy");
+  REQUIRE(npy1.data->cols() == 1);
+  REQUIRE(npy1.data->rows() == 3);
+  CHECK(npy1.names[0] == "0");
+  CHECK(npy1.data->begin(0).is_contiguous());
+  CHECK(npy1.data->begin(0)[1] == 5.f);
+  CHECK(npy1.data->minmax(0) == std::make_pair(1.f, 5.f));
+
+  // the columns of a 2D float array are used in place, with a stride
+  write_file("test_npy_2d.npy",
+             npy("'<f4'", "(3, 2)",
+                 to_bytes(std::vector<float>{1, 2, 3, 4, 5, 6})));
+  auto npy2 = load_npy("test_npy_2d.npy");
+  REQUIRE(npy2.data->cols() == 2);
+  REQUIRE(npy2.data->rows() == 3);
+  CHECK(npy2.data->begin(1).stride() == 2);
+  CHECK(npy2.data->begin(1)[2] == 6.f);
+
+  write_file("test_npy_fortran.npy",
+             npy("'<i2'", "(3, 2)",
+                 to_bytes(std::vector<int16_t>{1, 2, 3, 4, 5, 6}), true));
+  auto npy3 = load_npy("test_npy_fortran.npy");
+  REQUIRE(npy3.data->cols() == 2);
+  CHECK(npy3.data->begin(0).decode(2) == 3.0);
+  CHECK(npy3.data->begin(1).decode(0) == 4.0);
+
+  CHECK_THROWS_AS(load_npy("test_npy_missing.npy"), Exception);
+  write_file("test_npy_bad.npy", "not a npy file");
+  CHECK_THROWS_AS(load_npy("test_npy_bad.npy"), Exception);
+
+  std::remove("test_npy_1d.npy");
+  std::remove("test_npy_2d.npy");
+  std::remove("test_npy_fortran.npy");
+  std::remove("test_npy_bad.npy");
+}
+
+TEST_CASE("load structured npy files", "[npy]") {
+  // rows of {float32 x, int64 t, 4 bytes padding, big-endian float64 y}
+  std::string body;
+  for (int i = 0; i < 4; ++i) {
+    const float x = 0.5f * i;
+    const int64_t t = 1500000000000 + i;
+    const double y = -1.0 * i;
+    std::string y_bytes(reinterpret_cast<const char *>(&y), sizeof(y));
+    std::reverse(y_bytes.begin(), y_bytes.end());
+    body += std::string(reinterpret_cast<const char *>(&x), sizeof(x)) +
+            std::string(reinterpret_cast<const char *>(&t), sizeof(t)) +
+            std::string(4, '\0') + y_bytes;
+  }
+  write_file("test_npy_struct.npy",
+             npy("[('x', '<f4'), ('t', '<i8'), ('', '|V4'), ('y', '>f8')]",
+                 "(4,)", body));
+
+  auto npy = load_npy("test_npy_struct.npy");
+  REQUIRE(npy.data->cols() == 3);
+  REQUIRE(npy.data->rows() == 4);
+  CHECK(npy.column("t") == 1);
+  CHECK_THROWS_AS(npy.column("z"), Exception);
+
+  // x is used in place, with a stride of one row
+  CHECK(npy.data->begin(0).stride() == 6);
+  CHECK(npy.data->begin(0)[3] == 1.5f);
+  CHECK(npy.data->begin(1).decode(3) == 1500000000003.0);
+  CHECK(npy.data->begin(2).decode(2) == -2.0);
+
+  DataWithAesthetic data(npy.data);
+  data.bind<Aesthetic::x>(npy.column("t"));
+  data.bind<Aesthetic::y>(npy.column("y"));
+  CHECK(data.begin<Aesthetic::y>().decode(1) == -1.0);
+  CHECK(data.limits().bmin[Aesthetic::y::index] == -3.f);
+
+  std::remove("test_npy_struct.npy");
+}
+
+TEST_CASE("load npz files", "[npy]") {
+  const std::string x =
+      npy("'<f4'", "(2,)", to_bytes(std::vector<float>{1, 2}));
+  const std::string y =
+      npy("'<f8'", "(2,)", to_bytes(std::vector<double>{3, 4}));
+  write_file("test_npy.npz", zip({{"x.npy", x}, {"y.npy", y}}));
+
+  auto arrays = load_npz("test_npy.npz");
+  REQUIRE(arrays.size() == 2);
+  CHECK(arrays["x"].data->begin(0)[1] == 2.f);
+  CHECK(arrays["y"].data->begin(0).decode(1) == 4.0);
+
+  write_file("test_npy_compressed.npz", zip({{"x.npy", x}}, 8));
+  CHECK_THROWS_AS(load_npz("test_npy_compressed.npz"), Exception);
+
+  // sizes and offsets given in zip64 form
+  write_file("test_npy_zip64.npz", zip({{"x.npy", x}, {"y.npy", y}}, 0, true));
+  arrays = load_npz("test_npy_zip64.npz");
+  REQUIRE(arrays.size() == 2);
+  CHECK(arrays["x"].data->begin(0)[1] == 2.f);
+  CHECK(arrays["y"].data->begin(0).decode(1) == 4.0);
+
+  std::remove("test_npy.npz");
+  std::remove("test_npy_compressed.npz");
+  std::remove("test_npy_zip64.npz");
+}
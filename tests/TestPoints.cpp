@@ -36,8 +36,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "DummyDraw.hpp"
 
 #include "trase.hpp"
+#include <cstdlib>
 #include <fstream>
 #include <random>
+#include <sstream>
 
 using namespace trase;
 
@@ -69,6 +71,88 @@ TEST_CASE("points creation", "[points]") {
   DummyDraw::draw("points", fig);
 }
 
+TEST_CASE("points from rows past 2^31", "[points]") {
+  // range columns store no data, so a data set can have more than 2^32 rows.
+  // A view of a few of them is drawn, which indexes the columns past INT_MAX
+  const size_t n = (size_t(1) << 32) + (size_t(1) << 21);
+  auto data = create_data()
+                  .x(Column::range(0.0, 1.0, n))
+                  .y(Column::range(0.0, 0.5, n));
+  auto rows = std::make_shared<std::vector<size_t>>(
+      std::initializer_list<size_t>{(size_t(1) << 31) + 1,
+                                    (size_t(1) << 32) + 3,
+                                    (size_t(1) << 32) + (size_t(1) << 20) + 1});
+  auto view = data.select(rows);
+  REQUIRE(view.rows() == 3);
+  // none of these rows is a float, so the limits are calculated in double
+  const auto x_limits =
+      Column::range(0.0, 1.0, n).select(rows).decoded_minmax();
+  CHECK(x_limits.first == static_cast<double>((*rows)[0]));
+  CHECK(x_limits.second == static_cast<double>((*rows)[2]));
+  auto x = view.begin<Aesthetic::x>();
+  auto y = view.begin<Aesthetic::y>();
+  for (size_t i = 0; i < rows->size(); ++i) {
+    CHECK(x.decode(i) == static_cast<double>((*rows)[i]));
+    CHECK(y.decode(i) == 0.5 * static_cast<double>((*rows)[i]));
+  }
+
+  auto fig = figure();
+  auto ax = fig->axis();
+  ax->points(view);
+  DummyDraw::draw("points_past_int_max", fig);
+
+  // the points are drawn at their positions along the axis
+  std::ostringstream out;
+  BackendSVG backend(out);
+  fig->draw(backend);
+  const std::string svg = out.str();
+  const std::string tag = "<circle cx=\"";
+  std::vector<float> cx;
+  for (size_t i = svg.find(tag); i != std::string::npos;
+       i = svg.find(tag, i + 1)) {
+    cx.push_back(std::stof(svg.substr(i + tag.size())));
+  }
+  REQUIRE(cx.size() == 3);
+  CHECK(cx[0] < cx[1]);
+  CHECK(cx[1] < cx[2]);
+  const double expected = static_cast<double>((*rows)[1] - (*rows)[0]) /
+                          static_cast<double>((*rows)[2] - (*rows)[0]);
+  CHECK((cx[1] - cx[0]) / (cx[2] - cx[0]) == Approx(expected).epsilon(1e-3));
+}
+
+TEST_CASE("points drawn in chunks between frames", "[points]") {
+  // more rows than are mapped to display coordinates at once. Halfway
+  // between the frames every point is at the same height
+  const size_t n = (size_t(1) << 16) + 3;
+  auto fig = figure();
+  auto ax = fig->axis();
+  auto pts = ax->points(create_data()
+                            .x(Column::range(0.0, 1.0, n))
+                            .y(Column::range(0.0, 1.0, n)));
+  pts->add_frame(create_data()
+                     .x(Column::range(0.0, 1.0, n))
+                     .y(Column::range(n - 1.0, -1.0, n)),
+                 1.f);
+
+  std::ostringstream out;
+  BackendSVG backend(out);
+  fig->draw(backend, 0.5f);
+  const std::string svg = out.str();
+  const std::string tag = "<circle cx=\"";
+  std::vector<float> cx, cy;
+  for (size_t i = svg.find(tag); i != std::string::npos;
+       i = svg.find(tag, i + 1)) {
+    cx.push_back(std::strtof(svg.c_str() + i + tag.size(), nullptr));
+    cy.push_back(std::strtof(svg.c_str() + svg.find("cy=\"", i) + 4, nullptr));
+  }
+  REQUIRE(cx.size() == n);
+  const float step = (cx[n - 1] - cx[0]) / static_cast<float>(n - 1);
+  for (size_t i : {size_t(1), size_t(1) << 16, n - 2}) {
+    CHECK(cx[i] - cx[0] == Approx(step * i).margin(0.05));
+    CHECK(cy[i] == Approx(cy[0]).margin(0.05));
+  }
+}
+
 TEST_CASE("points legend", "[points]") {
   auto fig = figure();
   auto ax = fig->axis();